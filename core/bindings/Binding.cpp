@@ -1,4 +1,5 @@
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <wx/log.h>
@@ -6,17 +7,59 @@
 #include "Behaviour.h"
 #include "BehaviourLandCoverChange.h"
 #include "Includes.h"
+#include "ModelBatch.h"
+#include "ModelEnsemble.h"
 #include "ModelHydro.h"
+#include "ModelNetwork.h"
+#include "ModifierLag.h"
 #include "Parameter.h"
 #include "ParameterVariable.h"
 #include "SettingsBasin.h"
 #include "SettingsModel.h"
 #include "SubBasin.h"
+#include "TimeSeries.h"
 #include "Utils.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
 
+/**
+ * Create a time series from a NumPy array of [time steps x hydro units]. C- or F-contiguous arrays of doubles, or of
+ * floats, are referenced without copying them and the array is kept alive by the time series. Other arrays are
+ * converted once. Float arrays are always kept in single precision, as the conversion would not add any precision.
+ */
+template <class Model>
+static bool CreateTimeSeriesFromArray(Model& model, const string& varName, const axd& time, const axi& ids,
+                                      const py::array& data, bool singlePrecision) {
+    if (data.ndim() != 2 || data.shape(0) != time.size() || data.shape(1) != ids.size()) {
+        wxLogError(_("Dimension mismatch in the forcing data."));
+        return false;
+    }
+
+    py::array block = data;
+    bool contiguous = data.flags() & (py::array::c_style | py::array::f_style);
+    bool isFloat = py::isinstance<py::array_t<float>>(data);
+    singlePrecision = singlePrecision || isFloat;
+    if (singlePrecision && !(isFloat && contiguous)) {
+        block = py::array_t<float, py::array::c_style | py::array::forcecast>::ensure(data);
+    } else if (!singlePrecision && !(py::isinstance<py::array_t<double>>(data) && contiguous)) {
+        block = py::array_t<double, py::array::c_style | py::array::forcecast>::ensure(data);
+    }
+    if (!block) {
+        throw py::error_already_set();
+    }
+    bool unitMajor = !(block.flags() & py::array::c_style);
+
+    // The reference to the array is released with the GIL held, whichever thread deletes the time series.
+    auto owner = new py::object(block);
+    std::shared_ptr<const void> values(block.data(), [owner](const void*) {
+        py::gil_scoped_acquire gil;
+        delete owner;
+    });
+
+    return model.CreateTimeSeries(varName, time, ids, std::move(values), unitMajor, singlePrecision);
+}
+
 PYBIND11_MODULE(_hydrobricks, m) {
     m.doc() = "hydrobricks Python interface";
 
@@ -26,12 +69,31 @@ PYBIND11_MODULE(_hydrobricks, m) {
     m.def("set_max_log_level", &SetMaxLogLevel, "Set the log level to max (max verbosity).");
     m.def("set_debug_log_level", &SetDebugLogLevel, "Set the log level to debug.");
     m.def("set_message_log_level", &SetMessageLogLevel, "Set the log level to message (standard).");
+    m.def(
+        "route_discharge",
+        [](const axd& discharge, const string& kernel, const vecDouble& parameters) {
+            return ModifierLag::ConvolveSeries(discharge, ModifierLag::BuildKernel(kernel, parameters));
+        },
+        "Route a discharge series by a unit hydrograph (parameters in time steps).", "discharge"_a, "kernel"_a,
+        "parameters"_a);
+    m.def("write_forcing_cache", &TimeSeries::WriteCache, "Write forcing data to a binary cache file.", "path"_a,
+          "time"_a, "ids"_a, "data_names"_a, "data"_a, "single_precision"_a = false);
 
     py::class_<SettingsModel>(m, "SettingsModel")
         .def(py::init<>())
         .def("log_all", &SettingsModel::SetLogAll, "Logging all components.", "log_all"_a = true)
         .def("add_logging_to", &SettingsModel::AddLoggingToItem, "Add logging to the item.", "name"_a)
         .def("set_solver", &SettingsModel::SetSolver, "Set the solver.", "name"_a)
+        .def("set_threads_nb", &SettingsModel::SetThreadsNb, "Set the number of threads to process the hydro units.",
+             "threads_nb"_a)
+        .def("set_solver_tolerances", &SettingsModel::SetSolverTolerances,
+             "Set the error tolerances of the adaptive solvers.", "absolute_tolerance"_a, "relative_tolerance"_a)
+        .def("set_analytical_linear_storages", &SettingsModel::SetAnalyticalLinearStorages,
+             "Integrate the storages emptied only by linear outflows analytically.", "active"_a = true)
+        .def("set_inline_rate_kernels", &SettingsModel::SetInlineRateKernels,
+             "Evaluate the rates of the common processes with the inlined kernels.", "active"_a = true)
+        .def("set_skip_quiescent_bricks", &SettingsModel::SetSkipQuiescentBricks,
+             "Skip the empty bricks without inputs during the time steps.", "active"_a = true)
         .def("set_timer", &SettingsModel::SetTimer, "Set the modelling time properties.", "start_date"_a, "end_date"_a,
              "time_step"_a, "time_step_unit"_a)
         .def("add_land_cover_brick", &SettingsModel::AddLandCoverBrick, "Add a land cover brick.", "name"_a, "kind"_a)
@@ -56,7 +118,9 @@ PYBIND11_MODULE(_hydrobricks, m) {
         .def("set_process_outputs_as_instantaneous", &SettingsModel::SetProcessOutputsAsInstantaneous,
              "Set the process outputs as instantaneous.")
         .def("set_process_outputs_as_static", &SettingsModel::SetProcessOutputsAsStatic,
-             "Set the process outputs as static.");
+             "Set the process outputs as static.")
+        .def("set_process_outputs_lag", &SettingsModel::SetProcessOutputsLag,
+             "Lag the process outputs to the outlet by a unit hydrograph.", "kernel"_a, "parameters"_a);
 
     py::class_<SettingsBasin>(m, "SettingsBasin")
         .def(py::init<>())
@@ -90,18 +154,25 @@ PYBIND11_MODULE(_hydrobricks, m) {
              "year_end"_a, "values"_a);
 
     py::class_<TimeSeries>(m, "TimeSeries")
-        .def_static("create", &TimeSeries::Create, "data_name"_a, "time"_a, "ids"_a, "data"_a);
+        .def_static("create",
+                    py::overload_cast<const string&, const axd&, const axi&, const axxd&, bool>(&TimeSeries::Create),
+                    "data_name"_a, "time"_a, "ids"_a, "data"_a, "single_precision"_a = false);
 
     py::class_<ModelHydro>(m, "ModelHydro")
         .def(py::init<>())
         .def("init_with_basin", &ModelHydro::InitializeWithBasin, "Initialize the model and create the sub basin.",
              "model_settings"_a, "basin_settings"_a)
+        .def("clone", &ModelHydro::Clone, "Create a replica of the model sharing its forcing data.",
+             "model_settings"_a, py::keep_alive<0, 2>())
         .def("add_behaviour", &ModelHydro::AddBehaviour, "Adding a behaviour to the model.", "behaviour"_a)
         .def("get_behaviours_nb", &ModelHydro::GetBehavioursNb, "Get the number of behaviours.")
         .def("get_behaviour_items_nb", &ModelHydro::GetBehaviourItemsNb, "Get the number of behaviour items.")
         .def("add_time_series", &ModelHydro::AddTimeSeries, "Adding a time series to the model.", "time_series"_a)
-        .def("create_time_series", &ModelHydro::CreateTimeSeries, "Create a time series and add it to the model.",
-             "data_name"_a, "time"_a, "ids"_a, "data"_a)
+        .def("create_time_series", &CreateTimeSeriesFromArray<ModelHydro>,
+             "Create a time series and add it to the model (the data array is referenced, not copied).",
+             "data_name"_a, "time"_a, "ids"_a, "data"_a, "single_precision"_a = false)
+        .def("add_time_series_from_cache", &ModelHydro::AddTimeSeriesFromCache,
+             "Add the time series of a binary forcing cache (memory-mapped).", "path"_a)
         .def("clear_time_series", &ModelHydro::ClearTimeSeries,
              "Clear time series. Use only if the time series were created with ModelHydro::ClearTimeSeries.")
         .def("attach_time_series_to_hydro_units", &ModelHydro::AttachTimeSeriesToHydroUnits, "Attach the time series.")
@@ -109,18 +180,91 @@ PYBIND11_MODULE(_hydrobricks, m) {
              "model_settings"_a)
         .def("forcing_loaded", &ModelHydro::ForcingLoaded, "Check if the forcing data were loaded.")
         .def("is_ok", &ModelHydro::IsOk, "Check if the model is correctly set up.")
-        .def("run", &ModelHydro::Run, "Run the model.")
+        .def("run", &ModelHydro::Run, "Run the model.", py::call_guard<py::gil_scoped_release>())
         .def("reset", &ModelHydro::Reset, "Reset the model before another run.")
         .def("save_as_initial_state", &ModelHydro::SaveAsInitialState, "Save the model state as initial conditions.")
+        .def("save_state", &ModelHydro::SaveState, "Save the full model state in memory and return its handle.")
+        .def("restore_state", &ModelHydro::RestoreState, "Restore a state saved in memory.", "handle"_a)
+        .def("clear_states", &ModelHydro::ClearStates, "Release the states saved in memory.")
+        .def("enable_boundary_replay", &ModelHydro::EnableBoundaryReplay,
+             "Replay the recorded inputs of the sub basin when only sub basin parameters change.", "active"_a = true)
+        .def("is_replaying_boundary", &ModelHydro::IsReplayingBoundary,
+             "Check if the last run replayed the recorded inputs of the sub basin.")
         .def("get_outlet_discharge", &ModelHydro::GetOutletDischarge, "Get the outlet discharge.")
         .def("get_total_outlet_discharge", &ModelHydro::GetTotalOutletDischarge, "Get the outlet discharge total.")
         .def("get_total_et", &ModelHydro::GetTotalET, "Get the total amount of water lost by evapotranspiration.")
+        .def("get_skipped_bricks_fraction", &ModelHydro::GetSkippedBricksFraction,
+             "Get the fraction of the bricks processing skipped as the bricks were quiescent.")
+        .def("get_skipped_units_fraction", &ModelHydro::GetSkippedUnitsFraction,
+             "Get the fraction of the hydro units processing skipped as all their bricks were quiescent.")
         .def("get_total_water_storage_changes", &ModelHydro::GetTotalWaterStorageChanges,
              "Get the total change in water storage.")
         .def("get_total_snow_storage_changes", &ModelHydro::GetTotalSnowStorageChanges,
              "Get the total change in snow storage.")
         .def("dump_outputs", &ModelHydro::DumpOutputs, "Dump the model outputs to file.", "path"_a);
 
+    py::class_<ModelNetwork>(m, "ModelNetwork")
+        .def(py::init<>())
+        .def("add_sub_basin", &ModelNetwork::AddSubBasin, "Add a sub basin to the network.", "model_settings"_a,
+             "basin_settings"_a)
+        .def("connect", &ModelNetwork::Connect, "Connect a sub basin to its downstream sub basin.", "upstream"_a,
+             "downstream"_a)
+        .def("initialize", &ModelNetwork::Initialize, "Sort the sub basins by levels.", "threads_nb"_a = 1)
+        .def("create_time_series", &CreateTimeSeriesFromArray<ModelNetwork>,
+             "Create a time series shared by all sub basins.", "data_name"_a, "time"_a, "ids"_a, "data"_a,
+             "single_precision"_a = false)
+        .def("attach_time_series_to_hydro_units", &ModelNetwork::AttachTimeSeriesToHydroUnits,
+             "Attach the time series.")
+        .def("run", &ModelNetwork::Run, "Run the network.", py::call_guard<py::gil_scoped_release>())
+        .def("reset", &ModelNetwork::Reset, "Reset the sub basins before another run.")
+        .def("get_sub_basins_nb", &ModelNetwork::GetSubBasinsNb, "Get the number of sub basins.")
+        .def("get_levels_nb", &ModelNetwork::GetLevelsNb, "Get the number of levels of the network.")
+        .def("get_outlet_discharges", &ModelNetwork::GetOutletDischarges,
+             "Get the outlet discharge of all sub basins [time steps x sub basins].");
+
+    py::class_<ModelEnsemble>(m, "ModelEnsemble")
+        .def(py::init<>())
+        .def("initialize", &ModelEnsemble::Initialize, "Create the members of the ensemble.", "model_settings"_a,
+             "basin_settings"_a, "members_nb"_a)
+        .def("set_parameter_value", &ModelEnsemble::SetParameterValue, "Set a parameter value for a member.",
+             "member"_a, "component"_a, "name"_a, "value"_a)
+        .def("create_time_series", &CreateTimeSeriesFromArray<ModelEnsemble>,
+             "Create a time series shared by all members.", "data_name"_a, "time"_a, "ids"_a, "data"_a,
+             "single_precision"_a = false)
+        .def("attach_time_series_to_hydro_units", &ModelEnsemble::AttachTimeSeriesToHydroUnits,
+             "Attach the time series.")
+        .def("run", &ModelEnsemble::Run, "Run all members together.", py::call_guard<py::gil_scoped_release>())
+        .def("reset", &ModelEnsemble::Reset, "Reset the members before another run.")
+        .def("get_members_nb", &ModelEnsemble::GetMembersNb, "Get the number of members.")
+        .def("get_outlet_discharges", &ModelEnsemble::GetOutletDischarges,
+             "Get the outlet discharge of all members [time steps x members].");
+
+    py::class_<ModelBatch>(m, "ModelBatch")
+        .def(py::init<>())
+        .def("initialize", &ModelBatch::Initialize, "Create the model replicas (one per worker, 0: number of cores).",
+             "model_settings"_a, "basin_settings"_a, "workers_nb"_a = 0)
+        .def("set_parameter_names", &ModelBatch::SetParameterNames,
+             "Define the parameters of the columns of the parameter matrix.", "components"_a, "names"_a)
+        .def("create_time_series", &CreateTimeSeriesFromArray<ModelBatch>,
+             "Create a time series shared by all replicas.", "data_name"_a, "time"_a, "ids"_a, "data"_a,
+             "single_precision"_a = false)
+        .def("attach_time_series_to_hydro_units", &ModelBatch::AttachTimeSeriesToHydroUnits,
+             "Attach the time series.")
+        .def("set_observations", &ModelBatch::SetObservations,
+             "Define the observations to compute an objective value for each set.", "observations"_a, "metric"_a,
+             "warmup"_a = 0)
+        .def("set_warmup_cache", &ModelBatch::SetWarmupCache,
+             "Reuse the state at the end of the spin-up for the sets sharing the key parameters.", "spin_up_steps"_a,
+             "key_parameters"_a)
+        .def("clear_warmup_cache", &ModelBatch::ClearWarmupCache, "Release the cached spin-up states.")
+        .def("get_warmup_cache_size", &ModelBatch::GetWarmupCacheSize, "Get the number of cached spin-up states.")
+        .def("run", &ModelBatch::Run, "Run the model for all parameter sets [sets x parameters].", "parameters"_a,
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_workers_nb", &ModelBatch::GetWorkersNb, "Get the number of workers.")
+        .def("get_outlet_discharges", &ModelBatch::GetOutletDischarges,
+             "Get the outlet discharge of all sets [sets x time steps].")
+        .def("get_objective_values", &ModelBatch::GetObjectiveValues, "Get the objective value of all sets.");
+
     py::class_<Behaviour>(m, "Behaviour").def(py::init<>());
 
     py::class_<BehaviourLandCoverChange, Behaviour>(m, "BehaviourLandCoverChange")
@@ -9,6 +9,7 @@ static const wxCmdLineEntryDesc cmdLineDesc[] = {
     {wxCMD_LINE_OPTION, NULL, "output-path", "Path to save the output from hydrobricks (no ending backslash)"},
     {wxCMD_LINE_OPTION, NULL, "start-date", "Starting date of the modelling (YYYY-MM-DD)"},
     {wxCMD_LINE_OPTION, NULL, "end-date", "Ending date of the modelling (YYYY-MM-DD)"},
+    {wxCMD_LINE_SWITCH, NULL, "single-precision", "Store the forcing data in single precision (halves the memory)"},
     {wxCMD_LINE_NONE}};
 
 static const wxString cmdLineLogo = wxT(
@@ -123,6 +123,8 @@ bool Hydrobricks::OnCmdLineParsed(wxCmdLineParser& parser) {
         return false;
     }
 
+    m_singlePrecision = parser.Found("single-precision");
+
     return wxAppConsole::OnCmdLineParsed(parser);
 }
 
@@ -158,7 +160,7 @@ int Hydrobricks::OnRun() {
 
         // Data
         vector<TimeSeries*> vecTimeSeries;
-        if (!TimeSeries::Parse(m_dataFile, vecTimeSeries)) {
+        if (!TimeSeries::Parse(m_dataFile, vecTimeSeries, 0, m_singlePrecision)) {
             return 1;
         }
 
@@ -50,6 +50,7 @@ class Hydrobricks : public wxAppConsole {
     string m_outputPath;
     string m_startDate;
     string m_endDate;
+    bool m_singlePrecision = false;
 
   private:
 };
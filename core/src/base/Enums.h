@@ -38,6 +38,15 @@ enum VariableType {
     Custom3
 };
 
+/**
+ * Handling of the inputs of the sub basin coming from the hydro units.
+ */
+enum BoundaryMode {
+    BoundaryOff,
+    BoundaryRecord,
+    BoundaryReplay
+};
+
 /**
  * Formats for time/date formatting or parsing.
  */
@@ -0,0 +1,105 @@
+#include "FileMapped.h"
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+FileMapped::FileMapped()
+    : m_data(nullptr),
+      m_size(0) {
+#ifdef __WXMSW__
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#endif
+}
+
+FileMapped::~FileMapped() {
+    Close();
+}
+
+bool FileMapped::Open(const string& path) {
+    Close();
+
+    if (!wxFile::Exists(path)) {
+        wxLogError(_("The file %s could not be found."), path);
+        return false;
+    }
+
+#ifdef __WXMSW__
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        wxLogError(_("The file %s could not be opened."), path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        wxLogError(_("The file %s is empty or its size could not be read."), path);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        wxLogError(_("The file %s could not be mapped."), path);
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        wxLogError(_("The file %s could not be mapped."), path);
+        return false;
+    }
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_size = size_t(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        wxLogError(_("The file %s could not be opened."), path);
+        return false;
+    }
+    struct stat status {};
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        close(fd);
+        wxLogError(_("The file %s is empty or its size could not be read."), path);
+        return false;
+    }
+    void* data = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping remains valid.
+    if (data == MAP_FAILED) {
+        wxLogError(_("The file %s could not be mapped."), path);
+        return false;
+    }
+    m_size = size_t(status.st_size);
+#endif
+
+    m_data = static_cast<const char*>(data);
+
+    return true;
+}
+
+void FileMapped::Close() {
+    if (m_data == nullptr) {
+        return;
+    }
+
+#ifdef __WXMSW__
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
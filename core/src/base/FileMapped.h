@@ -0,0 +1,46 @@
+#ifndef HYDROBRICKS_FILE_MAPPED_H
+#define HYDROBRICKS_FILE_MAPPED_H
+
+#include "Includes.h"
+
+/**
+ * Read-only memory mapping of a whole file. The pages are loaded on demand and shared through the page cache
+ * between all the processes mapping the same file.
+ */
+class FileMapped : public wxObject {
+  public:
+    explicit FileMapped();
+
+    ~FileMapped() override;
+
+    /**
+     * Map an existing file.
+     *
+     * @param path Path of the existing file.
+     * @return True if successful, false otherwise.
+     */
+    bool Open(const string& path);
+
+    /**
+     * Unmap the file. Not mandatory as the file is unmapped in the destructor if still mapped.
+     */
+    void Close();
+
+    const char* GetData() const {
+        return m_data;
+    }
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+  protected:
+    const char* m_data;
+    size_t m_size;
+#ifdef __WXMSW__
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
+
+#endif  // HYDROBRICKS_FILE_MAPPED_H
@@ -163,6 +163,14 @@ axxd FileNetcdf::GetVarDouble2D(int varId, int rows, int cols) {
     return values;
 }
 
+void FileNetcdf::GetVarDouble2DBlock(int varId, const size_t start[2], const size_t count[2], double* values) {
+    CheckNcStatus(nc_get_vara_double(m_ncId, varId, start, count, values));
+}
+
+void FileNetcdf::GetVarFloat2DBlock(int varId, const size_t start[2], const size_t count[2], float* values) {
+    CheckNcStatus(nc_get_vara_float(m_ncId, varId, start, count, values));
+}
+
 void FileNetcdf::PutVar(int varId, const vecInt& values) {
     CheckNcStatus(nc_put_var_int(m_ncId, varId, &values[0]));
 }
@@ -159,6 +159,26 @@ class FileNetcdf : public wxObject {
      */
     axxd GetVarDouble2D(int varId, int rows, int cols);
 
+    /**
+     * Get a block of values of a 2D double variable.
+     *
+     * @param varId The id of the variable of interest.
+     * @param start The start index along both dimensions.
+     * @param count The number of values along both dimensions.
+     * @param values The storage of the values (count[0] x count[1], row-major).
+     */
+    void GetVarDouble2DBlock(int varId, const size_t start[2], const size_t count[2], double* values);
+
+    /**
+     * Get a block of values of a 2D variable as float.
+     *
+     * @param varId The id of the variable of interest.
+     * @param start The start index along both dimensions.
+     * @param count The number of values along both dimensions.
+     * @param values The storage of the values (count[0] x count[1], row-major).
+     */
+    void GetVarFloat2DBlock(int varId, const size_t start[2], const size_t count[2], float* values);
+
     /**
      * Set the variable values from a vector of integers.
      *
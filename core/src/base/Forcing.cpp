@@ -2,14 +2,21 @@
 
 Forcing::Forcing(VariableType type)
     : m_type(type),
-      m_timeSeriesData(nullptr) {}
+      m_timeSeriesData(nullptr),
+      m_row(nullptr),
+      m_offset(0),
+      m_singlePrecision(false) {}
 
 void Forcing::AttachTimeSeriesData(TimeSeriesData* timeSeriesData) {
     wxASSERT(timeSeriesData);
     m_timeSeriesData = timeSeriesData;
+    m_row = nullptr;
 }
 
-double Forcing::GetValue() {
-    wxASSERT(m_timeSeriesData);
-    return m_timeSeriesData->GetCurrentValue();
+void Forcing::AttachValues(const void* const* row, size_t offset, bool singlePrecision) {
+    wxASSERT(row);
+    m_row = row;
+    m_offset = offset;
+    m_singlePrecision = singlePrecision;
+    m_timeSeriesData = nullptr;
 }
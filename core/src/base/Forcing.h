@@ -12,15 +12,36 @@ class Forcing : public wxObject {
 
     void AttachTimeSeriesData(TimeSeriesData* timeSeriesData);
 
+    /**
+     * Read the values from a block of values of all hydro units, through the pointer to the current time step.
+     *
+     * @param row Pointer to the pointer of the values of the current time step.
+     * @param offset The offset of the value of the hydro unit from the pointer of the current time step.
+     * @param singlePrecision True if the values are float instead of double.
+     */
+    void AttachValues(const void* const* row, size_t offset, bool singlePrecision = false);
+
     VariableType GetType() {
         return m_type;
     }
 
-    double GetValue();
+    double GetValue() {
+        if (m_row) {
+            if (m_singlePrecision) {
+                return static_cast<const float*>(*m_row)[m_offset];
+            }
+            return static_cast<const double*>(*m_row)[m_offset];
+        }
+        wxASSERT(m_timeSeriesData);
+        return m_timeSeriesData->GetCurrentValue();
+    }
 
   protected:
     VariableType m_type;
     TimeSeriesData* m_timeSeriesData;
+    const void* const* m_row;
+    size_t m_offset;
+    bool m_singlePrecision;
 
   private:
 };
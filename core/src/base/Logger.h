@@ -69,6 +69,14 @@ class Logger : public wxObject {
         m_recordFractions = true;
     }
 
+    int GetCursor() const {
+        return m_cursor;
+    }
+
+    void SetCursor(int cursor) {
+        m_cursor = cursor;
+    }
+
   protected:
     int m_cursor;
     axd m_time;
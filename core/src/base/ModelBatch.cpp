@@ -0,0 +1,405 @@
+#include "ModelBatch.h"
+
+#include <thread>
+
+ModelBatch::ModelBatch()
+    : m_warmup(0),
+      m_threadPool(nullptr),
+      m_nextSet(0),
+      m_spinUpSteps(0) {}
+
+ModelBatch::~ModelBatch() {
+    for (auto replica : m_replicas) {
+        SubBasin* subBasin = replica->GetSubBasin();
+        wxDELETE(replica);
+        wxDELETE(subBasin);
+    }
+    for (auto settings : m_settings) {
+        wxDELETE(settings);
+    }
+    for (auto timeSeries : m_ownedTimeSeries) {
+        wxDELETE(timeSeries);
+    }
+    wxDELETE(m_threadPool);
+}
+
+bool ModelBatch::Initialize(SettingsModel& modelSettings, SettingsBasin& basinSettings, int workersNb) {
+    if (!m_replicas.empty()) {
+        wxLogError(_("The batch runner was already initialized."));
+        return false;
+    }
+    if (workersNb < 0) {
+        wxLogError(_("The number of workers cannot be negative (%d given)."), workersNb);
+        return false;
+    }
+    if (workersNb == 0) {
+        workersNb = wxMax(1, int(std::thread::hardware_concurrency()));
+    }
+
+    if (workersNb > 1) {
+        m_threadPool = new ThreadPool(workersNb);
+    }
+
+    for (int i = 0; i < workersNb; ++i) {
+        // The parameter sets are processed concurrently, not the hydro units.
+        auto settings = new SettingsModel(modelSettings);
+        settings->SetThreadsNb(1);
+        m_settings.push_back(settings);
+
+        // The first replica is built from the settings and the others are cloned from it.
+        if (i == 0) {
+            auto replica = new ModelHydro();
+            m_replicas.push_back(replica);
+            if (!replica->InitializeWithBasin(*settings, basinSettings)) {
+                return false;
+            }
+        } else {
+            ModelHydro* replica = m_replicas[0]->Clone(*settings);
+            if (!replica) {
+                return false;
+            }
+            m_replicas.push_back(replica);
+        }
+    }
+
+    return true;
+}
+
+bool ModelBatch::SetParameterNames(const vecStr& components, const vecStr& names) {
+    if (components.size() != names.size()) {
+        wxLogError(_("The number of components (%d) does not match the number of parameter names (%d)."),
+                   int(components.size()), int(names.size()));
+        return false;
+    }
+
+    m_parameterComponents = components;
+    m_parameterNames = names;
+
+    return true;
+}
+
+bool ModelBatch::AddTimeSeries(TimeSeries* timeSeries) {
+    if (m_replicas.empty()) {
+        wxLogError(_("The batch runner must be initialized before adding time series."));
+        return false;
+    }
+
+    // The first replica reads the original series and the others get copies sharing its values.
+    if (!m_replicas[0]->AddTimeSeries(timeSeries)) {
+        return false;
+    }
+    for (int i = 1; i < m_replicas.size(); ++i) {
+        TimeSeries* clone = timeSeries->CloneSharingValues();
+        m_ownedTimeSeries.push_back(clone);
+        if (!m_replicas[i]->AddTimeSeries(clone)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelBatch::CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, data);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelBatch::CreateTimeSeries(const string& varName, const axd& time, const axi& ids,
+                                  std::shared_ptr<const void> data, bool unitMajor, bool singlePrecision) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, std::move(data), unitMajor, singlePrecision);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelBatch::AttachTimeSeriesToHydroUnits() {
+    for (auto replica : m_replicas) {
+        if (!replica->AttachTimeSeriesToHydroUnits()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelBatch::SetObservations(const axd& observations, const string& metric, int warmup) {
+    if (m_replicas.empty()) {
+        wxLogError(_("The batch runner must be initialized before setting the observations."));
+        return false;
+    }
+    if (metric != "nse" && metric != "kge_2012" && metric != "rmse") {
+        wxLogError(_("The metric '%s' is not supported."), metric);
+        return false;
+    }
+
+    int timeStepsNb = m_replicas[0]->GetTimeMachine()->GetTimeStepsNb();
+    if (observations.size() != timeStepsNb) {
+        wxLogError(_("The length of the observations (%d) does not match the number of time steps (%d)."),
+                   int(observations.size()), timeStepsNb);
+        return false;
+    }
+    if (warmup < 0 || warmup >= timeStepsNb) {
+        wxLogError(_("The warmup period (%d) is not compatible with the number of time steps (%d)."), warmup,
+                   timeStepsNb);
+        return false;
+    }
+
+    m_observations = observations;
+    m_metric = metric;
+    m_warmup = warmup;
+
+    return true;
+}
+
+bool ModelBatch::SetWarmupCache(int spinUpSteps, const vecInt& keyParameters) {
+    if (m_replicas.empty()) {
+        wxLogError(_("The batch runner must be initialized before enabling the warm-up cache."));
+        return false;
+    }
+
+    int timeStepsNb = m_replicas[0]->GetTimeMachine()->GetTimeStepsNb();
+    if (spinUpSteps < 0 || spinUpSteps >= timeStepsNb) {
+        wxLogError(_("The spin-up period (%d) is not compatible with the number of time steps (%d)."), spinUpSteps,
+                   timeStepsNb);
+        return false;
+    }
+    for (auto index : keyParameters) {
+        if (index < 0 || index >= m_parameterNames.size()) {
+            wxLogError(_("The parameter index %d is out of range."), index);
+            return false;
+        }
+    }
+
+    m_spinUpSteps = spinUpSteps;
+    m_spinUpKeyParameters = keyParameters;
+    ClearWarmupCache();
+
+    return true;
+}
+
+void ModelBatch::ClearWarmupCache() {
+    m_spinUpStates.clear();
+}
+
+bool ModelBatch::Run(const axxd& parameters) {
+    if (m_replicas.empty()) {
+        wxLogError(_("The batch runner has no replica."));
+        return false;
+    }
+    if (parameters.cols() != m_parameterNames.size()) {
+        wxLogError(_("The number of columns of the parameter matrix (%d) does not match the parameters number (%d)."),
+                   int(parameters.cols()), int(m_parameterNames.size()));
+        return false;
+    }
+
+    int setsNb = int(parameters.rows());
+    int timeStepsNb = m_replicas[0]->GetTimeMachine()->GetTimeStepsNb();
+    m_discharges = axxd::Constant(setsNb, timeStepsNb, NAN_D);
+    m_objectives = axd::Constant(setsNb, NAN_D);
+    m_nextSet = 0;
+    if (m_spinUpSteps > 0) {
+        PrepareSpinUpCache(parameters);
+    }
+
+    wxLogMessage(_("Batch simulation of %d parameter sets starting."), setsNb);
+
+    // Every replica pulls the next set to simulate, so that the workers stay busy until all sets are done.
+    vector<char> success(m_replicas.size(), 1);
+    auto runReplica = [this, &parameters, &success, setsNb](int iReplica) {
+        int set;
+        while ((set = m_nextSet.fetch_add(1)) < setsNb) {
+            if (!RunSet(iReplica, parameters, set)) {
+                SignalSpinUpFailure(set);
+                success[iReplica] = 0;
+            }
+        }
+    };
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(int(m_replicas.size()), runReplica);
+    } else {
+        runReplica(0);
+    }
+
+    for (auto replicaSuccess : success) {
+        if (!replicaSuccess) {
+            wxLogError(_("Some parameter sets failed to run."));
+            return false;
+        }
+    }
+
+    wxLogMessage(_("Batch simulation completed."));
+
+    return true;
+}
+
+bool ModelBatch::RunSet(int replica, const axxd& parameters, int set) {
+    ModelHydro* model = m_replicas[replica];
+    SettingsModel* settings = m_settings[replica];
+
+    try {
+        model->Reset();
+        for (int i = 0; i < m_parameterNames.size(); ++i) {
+            if (!settings->SetParameterValue(m_parameterComponents[i], m_parameterNames[i],
+                                             float(parameters(set, i)))) {
+                return false;
+            }
+        }
+        model->UpdateParameters(*settings);
+
+        if (m_spinUpSteps > 0) {
+            if (!RunWithSpinUpCache(model, parameters, set)) {
+                return false;
+            }
+        } else if (!model->Run()) {
+            return false;
+        }
+
+        axd discharge = model->GetOutletDischarge();
+        if (m_spinUpSteps > 0) {
+            // Not simulated when starting from a cached state.
+            discharge.head(m_spinUpSteps) = NAN_D;
+        }
+        m_discharges.row(set) = discharge.transpose();
+        if (!m_metric.empty()) {
+            m_objectives[set] = Evaluate(discharge);
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during the simulation of the parameter set %d: %s."), set, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+vector<float> ModelBatch::GetSpinUpKey(const axxd& parameters, int set) const {
+    vector<float> key;
+    key.reserve(m_spinUpKeyParameters.size());
+    for (auto index : m_spinUpKeyParameters) {
+        key.push_back(float(parameters(set, index)));
+    }
+
+    return key;
+}
+
+void ModelBatch::PrepareSpinUpCache(const axxd& parameters) {
+    // Forget the spin-ups that failed in a previous run.
+    for (auto entry = m_spinUpStates.begin(); entry != m_spinUpStates.end();) {
+        if (entry->second.get().empty()) {
+            entry = m_spinUpStates.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+
+    // The first set of every new key simulates its spin-up. As the sets are pulled in order, it is always pulled
+    // before the sets waiting for it, which makes the cached states independent of the threads scheduling.
+    m_spinUpSources.clear();
+    for (int set = 0; set < parameters.rows(); ++set) {
+        vector<float> key = GetSpinUpKey(parameters, set);
+        if (m_spinUpStates.find(key) == m_spinUpStates.end()) {
+            std::promise<vecDouble>& promise = m_spinUpSources[set];
+            m_spinUpStates.emplace(key, promise.get_future().share());
+        }
+    }
+}
+
+void ModelBatch::SignalSpinUpFailure(int set) {
+    // The sets waiting for the spin-up state of this set must not wait forever.
+    auto source = m_spinUpSources.find(set);
+    if (source != m_spinUpSources.end()) {
+        try {
+            source->second.set_value(vecDouble());
+        } catch (const std::future_error&) {
+            // The state was already provided.
+        }
+    }
+}
+
+bool ModelBatch::RunWithSpinUpCache(ModelHydro* model, const axxd& parameters, int set) {
+    // The cache is not modified while the sets are simulated.
+    auto source = m_spinUpSources.find(set);
+    if (source == m_spinUpSources.end()) {
+        const vecDouble& state = m_spinUpStates.at(GetSpinUpKey(parameters, set)).get();
+        if (state.empty()) {
+            wxLogError(_("The spin-up of the parameter set %d failed."), set);
+            return false;
+        }
+        if (!model->SetState(state)) {
+            return false;
+        }
+    } else {
+        if (!model->PrepareRun()) {
+            return false;
+        }
+        for (int i = 0; i < m_spinUpSteps && !model->IsOver(); ++i) {
+            if (!model->ProcessTimeStep() || !model->UpdateForcing()) {
+                return false;
+            }
+        }
+        source->second.set_value(model->GetState());
+    }
+
+    // Continue from the end of the spin-up period.
+    return model->Run();
+}
+
+double ModelBatch::Evaluate(const axd& discharge) const {
+    wxASSERT(discharge.size() == m_observations.size());
+
+    // Keep only the time steps with observations and simulated values (none during a cached spin-up).
+    vecDouble sim;
+    vecDouble obs;
+    for (int i = m_warmup; i < discharge.size(); ++i) {
+        if (IsNaN(m_observations[i]) || IsNaN(discharge[i])) {
+            continue;
+        }
+        sim.push_back(discharge[i]);
+        obs.push_back(m_observations[i]);
+    }
+    if (obs.empty()) {
+        return NAN_D;
+    }
+
+    Eigen::Map<const axd> s(sim.data(), Eigen::Index(sim.size()));
+    Eigen::Map<const axd> o(obs.data(), Eigen::Index(obs.size()));
+
+    if (m_metric == "rmse") {
+        return std::sqrt((s - o).square().mean());
+    }
+
+    double meanObs = o.mean();
+
+    if (m_metric == "nse") {
+        return 1.0 - (s - o).square().sum() / (o - meanObs).square().sum();
+    }
+
+    if (m_metric == "kge_2012") {
+        double meanSim = s.mean();
+        double stdSim = std::sqrt((s - meanSim).square().mean());
+        double stdObs = std::sqrt((o - meanObs).square().mean());
+        double r = ((s - meanSim) * (o - meanObs)).mean() / (stdSim * stdObs);
+        double beta = meanSim / meanObs;
+        double gamma = (stdSim / meanSim) / (stdObs / meanObs);
+        return 1.0 - std::sqrt((r - 1) * (r - 1) + (beta - 1) * (beta - 1) + (gamma - 1) * (gamma - 1));
+    }
+
+    throw ShouldNotHappen();
+}
@@ -0,0 +1,166 @@
+#ifndef HYDROBRICKS_MODEL_BATCH_H
+#define HYDROBRICKS_MODEL_BATCH_H
+
+#include <atomic>
+#include <future>
+#include <map>
+
+#include "Includes.h"
+#include "ModelHydro.h"
+#include "SettingsBasin.h"
+#include "SettingsModel.h"
+#include "ThreadPool.h"
+
+/**
+ * Batch runner evaluating many parameter sets of the same model (e.g. for calibration). Each worker thread owns a
+ * replica of the model and pulls the next parameter set to simulate until all sets are done. The forcing values are
+ * shared read-only between the replicas, which only have their own cursors.
+ */
+class ModelBatch : public wxObject {
+  public:
+    explicit ModelBatch();
+
+    ~ModelBatch() override;
+
+    /**
+     * Create the model replicas, one per worker.
+     *
+     * @param modelSettings The model settings (structure and default parameter values).
+     * @param basinSettings The basin settings.
+     * @param workersNb The number of workers. If 0, the number of cores is used.
+     * @return True if successful, false otherwise.
+     */
+    bool Initialize(SettingsModel& modelSettings, SettingsBasin& basinSettings, int workersNb = 0);
+
+    /**
+     * Define the parameters corresponding to the columns of the parameter matrix.
+     *
+     * @param components The name of the component (brick or splitter) or the type of the components for each column.
+     * @param names The name of the parameter for each column.
+     * @return True if successful, false otherwise.
+     */
+    bool SetParameterNames(const vecStr& components, const vecStr& names);
+
+    /**
+     * Add a time series to all replicas. The time series is not owned by the batch runner, but its values must remain
+     * available while the batch runner is used.
+     *
+     * @param timeSeries The time series to add.
+     * @return True if successful, false otherwise.
+     */
+    bool AddTimeSeries(TimeSeries* timeSeries);
+
+    /**
+     * Create a time series owned by the batch runner and add it to all replicas.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data);
+
+    /**
+     * Create a time series owned by the batch runner referencing an existing block of values (see TimeSeries::Create())
+     * and add it to all replicas.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, std::shared_ptr<const void> data,
+                          bool unitMajor, bool singlePrecision = false);
+
+    bool AttachTimeSeriesToHydroUnits();
+
+    /**
+     * Define the observed discharge to compute an objective value for each parameter set.
+     *
+     * @param observations The observed discharge, matching the simulated time steps. Missing values (NaN) are ignored.
+     * @param metric The metric to compute: "nse", "kge_2012" or "rmse".
+     * @param warmup The number of time steps to discard at the beginning of the period. The time steps without
+     * simulated values (e.g. the spin-up period of the warm-up cache) are discarded as well.
+     * @return True if successful, false otherwise.
+     */
+    bool SetObservations(const axd& observations, const string& metric, int warmup = 0);
+
+    /**
+     * Enable the warm-up cache. The state at the end of the spin-up period is stored, keyed by the values of the
+     * parameters influencing it, and the sets sharing these values start from the stored state instead of simulating
+     * the spin-up again. The discharge of the spin-up period is then not available (NaN) for any set.
+     *
+     * @param spinUpSteps The number of time steps of the spin-up period (0 to disable the cache).
+     * @param keyParameters The indices of the columns of the parameter matrix influencing the spin-up storages. If
+     * empty, all sets share the same spin-up state. The state of a key is always simulated with the first set (in the
+     * order of the parameter matrix) having this key, the other sets waiting for it.
+     * @return True if successful, false otherwise.
+     */
+    bool SetWarmupCache(int spinUpSteps, const vecInt& keyParameters);
+
+    /**
+     * Release the cached spin-up states (required if the forcing changes between runs).
+     */
+    void ClearWarmupCache();
+
+    int GetWarmupCacheSize() const {
+        return int(m_spinUpStates.size());
+    }
+
+    /**
+     * Run the model for all parameter sets.
+     *
+     * @param parameters The parameter values as a matrix of [sets x parameters].
+     * @return True if all sets ran successfully, false otherwise.
+     */
+    bool Run(const axxd& parameters);
+
+    /**
+     * Get the outlet discharge of the last run. Failed sets are filled with NaN.
+     *
+     * @return The discharge as a matrix of [sets x time steps].
+     */
+    axxd GetOutletDischarges() const {
+        return m_discharges;
+    }
+
+    /**
+     * Get the objective values of the last run (requires observations to be set). Failed sets get NaN.
+     *
+     * @return The objective value of every set.
+     */
+    axd GetObjectiveValues() const {
+        return m_objectives;
+    }
+
+    int GetWorkersNb() const {
+        return int(m_replicas.size());
+    }
+
+  protected:
+    vector<SettingsModel*> m_settings;
+    vector<ModelHydro*> m_replicas;
+    vector<TimeSeries*> m_ownedTimeSeries;
+    vecStr m_parameterComponents;
+    vecStr m_parameterNames;
+    axd m_observations;
+    string m_metric;
+    int m_warmup;
+    axxd m_discharges;
+    axd m_objectives;
+    ThreadPool* m_threadPool;
+    std::atomic<int> m_nextSet;
+    int m_spinUpSteps;
+    vecInt m_spinUpKeyParameters;
+    std::map<vector<float>, std::shared_future<vecDouble>> m_spinUpStates;
+    std::map<int, std::promise<vecDouble>> m_spinUpSources;  // Sets simulating the spin-up of a new key in a run.
+
+  private:
+    bool RunSet(int replica, const axxd& parameters, int set);
+
+    vector<float> GetSpinUpKey(const axxd& parameters, int set) const;
+
+    void PrepareSpinUpCache(const axxd& parameters);
+
+    void SignalSpinUpFailure(int set);
+
+    bool RunWithSpinUpCache(ModelHydro* model, const axxd& parameters, int set);
+
+    double Evaluate(const axd& discharge) const;
+};
+
+#endif  // HYDROBRICKS_MODEL_BATCH_H
@@ -0,0 +1,181 @@
+#include "ModelEnsemble.h"
+
+ModelEnsemble::ModelEnsemble()
+    : m_threadPool(nullptr) {}
+
+ModelEnsemble::~ModelEnsemble() {
+    for (auto member : m_members) {
+        SubBasin* subBasin = member->GetSubBasin();
+        wxDELETE(member);
+        wxDELETE(subBasin);
+    }
+    for (auto settings : m_settings) {
+        wxDELETE(settings);
+    }
+    for (auto timeSeries : m_ownedTimeSeries) {
+        wxDELETE(timeSeries);
+    }
+    wxDELETE(m_threadPool);
+}
+
+bool ModelEnsemble::Initialize(SettingsModel& modelSettings, SettingsBasin& basinSettings, int membersNb) {
+    if (!m_members.empty()) {
+        wxLogError(_("The ensemble was already initialized."));
+        return false;
+    }
+    if (membersNb < 1) {
+        wxLogError(_("The number of members must be positive (%d given)."), membersNb);
+        return false;
+    }
+
+    int threadsNb = wxMin(modelSettings.GetSolverSettings().threadsNb, membersNb);
+    if (threadsNb > 1) {
+        m_threadPool = new ThreadPool(threadsNb);
+    }
+
+    for (int i = 0; i < membersNb; ++i) {
+        // The members are processed concurrently, not their hydro units.
+        auto settings = new SettingsModel(modelSettings);
+        settings->SetThreadsNb(1);
+        m_settings.push_back(settings);
+
+        // The first member is built from the settings and the others are cloned from it.
+        if (i == 0) {
+            auto member = new ModelHydro();
+            m_members.push_back(member);
+            if (!member->InitializeWithBasin(*settings, basinSettings)) {
+                return false;
+            }
+        } else {
+            ModelHydro* member = m_members[0]->Clone(*settings);
+            if (!member) {
+                return false;
+            }
+            m_members.push_back(member);
+        }
+    }
+
+    return true;
+}
+
+bool ModelEnsemble::SetParameterValue(int member, const string& component, const string& name, float value) {
+    if (member < 0 || member >= m_settings.size()) {
+        wxLogError(_("The member %d does not exist."), member);
+        return false;
+    }
+
+    return m_settings[member]->SetParameterValue(component, name, value);
+}
+
+bool ModelEnsemble::AddTimeSeries(TimeSeries* timeSeries) {
+    for (auto member : m_members) {
+        if (!member->AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelEnsemble::CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, data);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelEnsemble::CreateTimeSeries(const string& varName, const axd& time, const axi& ids,
+                                     std::shared_ptr<const void> data, bool unitMajor, bool singlePrecision) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, std::move(data), unitMajor, singlePrecision);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelEnsemble::AttachTimeSeriesToHydroUnits() {
+    for (auto member : m_members) {
+        if (!member->AttachTimeSeriesToHydroUnits()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelEnsemble::Run() {
+    if (m_members.empty()) {
+        wxLogError(_("The ensemble has no member."));
+        return false;
+    }
+
+    // The values copied when building the members (e.g. the rate kernels) must reflect the member parameters.
+    for (int i = 0; i < m_members.size(); ++i) {
+        m_members[i]->UpdateParameters(*m_settings[i]);
+        if (!m_members[i]->PrepareRun()) {
+            return false;
+        }
+    }
+
+    wxLogMessage(_("Ensemble simulation starting."));
+
+    // The forcing data are shared: the members are processed with the same forcing and advanced once per time step.
+    vector<char> success(m_members.size());
+    auto processMember = [this, &success](int i) { success[i] = m_members[i]->ProcessTimeStep(); };
+    while (!m_members[0]->IsOver()) {
+        if (m_threadPool) {
+            m_threadPool->ParallelFor(int(m_members.size()), processMember);
+        } else {
+            for (int i = 0; i < m_members.size(); ++i) {
+                processMember(i);
+            }
+        }
+        for (auto memberSuccess : success) {
+            if (!memberSuccess) {
+                return false;
+            }
+        }
+        if (!m_members[0]->UpdateForcing()) {
+            wxLogError(_("Failed updating the forcing data."));
+            return false;
+        }
+    }
+
+    wxLogMessage(_("Ensemble simulation completed."));
+
+    return true;
+}
+
+void ModelEnsemble::Reset() {
+    for (auto member : m_members) {
+        member->Reset();
+    }
+}
+
+axxd ModelEnsemble::GetOutletDischarges() {
+    if (m_members.empty()) {
+        return {};
+    }
+
+    axxd discharges(m_members[0]->GetOutletDischarge().size(), m_members.size());
+    for (int i = 0; i < m_members.size(); ++i) {
+        discharges.col(i) = m_members[i]->GetOutletDischarge();
+    }
+
+    return discharges;
+}
@@ -0,0 +1,96 @@
+#ifndef HYDROBRICKS_MODEL_ENSEMBLE_H
+#define HYDROBRICKS_MODEL_ENSEMBLE_H
+
+#include "Includes.h"
+#include "ModelHydro.h"
+#include "SettingsBasin.h"
+#include "SettingsModel.h"
+#include "ThreadPool.h"
+
+/**
+ * Ensemble of models sharing the same structure and forcing data but having different parameter values. All the
+ * members are advanced together (lock-step): the forcing data are read once per time step for all members and the
+ * members are processed concurrently when multiple threads are used.
+ */
+class ModelEnsemble : public wxObject {
+  public:
+    explicit ModelEnsemble();
+
+    ~ModelEnsemble() override;
+
+    /**
+     * Create the members of the ensemble. Each member gets its own copy of the model settings. The number of threads
+     * defined in the solver settings is used to process the members concurrently.
+     *
+     * @param modelSettings The model settings (structure and default parameter values).
+     * @param basinSettings The basin settings.
+     * @param membersNb The number of members.
+     * @return True if successful, false otherwise.
+     */
+    bool Initialize(SettingsModel& modelSettings, SettingsBasin& basinSettings, int membersNb);
+
+    /**
+     * Set a parameter value for a given member.
+     *
+     * @param member The index of the member.
+     * @param component The name of the component (brick or splitter) or the type of the components.
+     * @param name The name of the parameter.
+     * @param value The parameter value.
+     * @return True if successful, false otherwise.
+     */
+    bool SetParameterValue(int member, const string& component, const string& name, float value);
+
+    /**
+     * Add a time series to all members. The time series is not owned by the ensemble.
+     *
+     * @param timeSeries The time series to add.
+     * @return True if successful, false otherwise.
+     */
+    bool AddTimeSeries(TimeSeries* timeSeries);
+
+    /**
+     * Create a time series owned by the ensemble and add it to all members.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data);
+
+    /**
+     * Create a time series owned by the ensemble referencing an existing block of values (see TimeSeries::Create())
+     * and add it to all members.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, std::shared_ptr<const void> data,
+                          bool unitMajor, bool singlePrecision = false);
+
+    bool AttachTimeSeriesToHydroUnits();
+
+    bool Run();
+
+    void Reset();
+
+    /**
+     * Get the outlet discharge of all members.
+     *
+     * @return The discharge as a matrix of [time steps x members].
+     */
+    axxd GetOutletDischarges();
+
+    int GetMembersNb() const {
+        return int(m_members.size());
+    }
+
+    ModelHydro* GetMember(int index) {
+        wxASSERT(index < m_members.size());
+        return m_members[index];
+    }
+
+  protected:
+    vector<SettingsModel*> m_settings;
+    vector<ModelHydro*> m_members;
+    vector<TimeSeries*> m_ownedTimeSeries;
+    ThreadPool* m_threadPool;
+};
+
+#endif  // HYDROBRICKS_MODEL_ENSEMBLE_H
@@ -1,5 +1,6 @@
 #include "ModelHydro.h"
 
+#include "Behaviour.h"
 #include "FluxForcing.h"
 #include "FluxSimple.h"
 #include "FluxToAtmosphere.h"
@@ -8,10 +9,14 @@
 #include "FluxToOutlet.h"
 #include "Includes.h"
 #include "LandCover.h"
+#include "ModifierLag.h"
+#include "ParameterVariable.h"
 #include "SurfaceComponent.h"
 
 ModelHydro::ModelHydro(SubBasin* subBasin)
-    : m_subBasin(subBasin) {
+    : m_subBasin(subBasin),
+      m_boundaryReplay(false),
+      m_recordedStartStep(-1) {
     m_processor.SetModel(this);
     m_behavioursManager.SetModel(this);
     m_timer.SetBehavioursManager(&m_behavioursManager);
@@ -36,17 +41,11 @@ bool ModelHydro::InitializeWithBasin(SettingsModel& modelSettings, SettingsBasin
 bool ModelHydro::Initialize(SettingsModel& modelSettings, SettingsBasin& basinProp) {
     try {
         BuildModelStructure(modelSettings);
-
-        m_timer.Initialize(modelSettings.GetTimerSettings());
-        g_timeStepInDays = *m_timer.GetTimeStepPointer();
-        m_processor.Initialize(modelSettings.GetSolverSettings());
-        if (modelSettings.LogAll()) {
-            m_logger.RecordFractions();
-        }
-        m_logger.InitContainers(m_timer.GetTimeStepsNb(), m_subBasin, modelSettings);
+        InitializeComponents(modelSettings);
         if (!m_subBasin->AssignFractions(basinProp)) {
             return false;
         }
+        m_processor.UpdateActiveBricks();
         ConnectLoggerToValues(modelSettings);
     } catch (const std::exception& e) {
         wxLogError(_("An exception occurred during model initialization: %s."), e.what());
@@ -56,6 +55,80 @@ bool ModelHydro::Initialize(SettingsModel& modelSettings, SettingsBasin& basinPr
     return true;
 }
 
+void ModelHydro::InitializeComponents(SettingsModel& modelSettings) {
+    m_timer.Initialize(modelSettings.GetTimerSettings());
+    m_processor.SetTimeStepInDays(*m_timer.GetTimeStepPointer());
+    m_processor.Initialize(modelSettings.GetSolverSettings());
+    if (modelSettings.LogAll()) {
+        m_logger.RecordFractions();
+    }
+    m_logger.InitContainers(m_timer.GetTimeStepsNb(), m_subBasin, modelSettings);
+    m_unitsParameters = GetHydroUnitsParameterValues(modelSettings);
+}
+
+vector<float> ModelHydro::GetHydroUnitsParameterValues(SettingsModel& modelSettings) {
+    vector<Parameter*> parameters;
+    for (int iBrick = 0; iBrick < modelSettings.GetHydroUnitBricksNb(); ++iBrick) {
+        modelSettings.SelectHydroUnitBrick(iBrick);
+        BrickSettings brickSettings = modelSettings.GetHydroUnitBrickSettings(iBrick);
+        parameters.insert(parameters.end(), brickSettings.parameters.begin(), brickSettings.parameters.end());
+        for (int iProcess = 0; iProcess < modelSettings.GetProcessesNb(); ++iProcess) {
+            ProcessSettings processSettings = modelSettings.GetProcessSettings(iProcess);
+            parameters.insert(parameters.end(), processSettings.parameters.begin(), processSettings.parameters.end());
+        }
+    }
+    for (int iSplitter = 0; iSplitter < modelSettings.GetHydroUnitSplittersNb(); ++iSplitter) {
+        SplitterSettings splitterSettings = modelSettings.GetHydroUnitSplitterSettings(iSplitter);
+        parameters.insert(parameters.end(), splitterSettings.parameters.begin(), splitterSettings.parameters.end());
+    }
+
+    vector<float> values;
+    values.reserve(parameters.size());
+    for (auto parameter : parameters) {
+        if (dynamic_cast<ParameterVariable*>(parameter)) {
+            values.push_back(NAN_F);
+        } else {
+            values.push_back(parameter->GetValue());
+        }
+    }
+
+    return values;
+}
+
+ModelHydro* ModelHydro::Clone(SettingsModel& modelSettings) {
+    if (m_behavioursManager.GetBehavioursNb() > 0) {
+        wxLogError(_("Models with behaviours cannot be cloned."));
+        return nullptr;
+    }
+
+    auto replica = new ModelHydro(m_subBasin->CloneHydroUnits());
+
+    try {
+        replica->BuildModelStructure(modelSettings);
+        replica->InitializeComponents(modelSettings);
+        replica->m_subBasin->CopyStateFrom(m_subBasin);
+        replica->m_processor.UpdateActiveBricks();
+        replica->ConnectLoggerToValues(modelSettings);
+
+        // The time series values are shared; only the cursors are specific to the replica.
+        for (auto timeSeries : m_timeSeries) {
+            replica->m_timeSeries.push_back(timeSeries->CloneSharingValues());
+        }
+        if (!replica->m_timeSeries.empty() && !replica->AttachTimeSeriesToHydroUnits()) {
+            throw ConceptionIssue(_("The time series could not be attached to the replica."));
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during model cloning: %s."), e.what());
+        SubBasin* subBasin = replica->GetSubBasin();
+        replica->ClearTimeSeries();
+        wxDELETE(replica);
+        wxDELETE(subBasin);
+        return nullptr;
+    }
+
+    return replica;
+}
+
 void ModelHydro::BuildModelStructure(SettingsModel& modelSettings) {
     if (modelSettings.GetStructuresNb() > 1) {
         throw NotImplemented();
@@ -76,6 +149,8 @@ void ModelHydro::UpdateParameters(SettingsModel& modelSettings) {
 
     UpdateSubBasinParameters(modelSettings);
     UpdateHydroUnitsParameters(modelSettings);
+    m_processor.BuildRateKernels();
+    m_unitsParameters = GetHydroUnitsParameterValues(modelSettings);
 }
 
 void ModelHydro::CreateSubBasinComponents(SettingsModel& modelSettings) {
@@ -333,6 +408,9 @@ void ModelHydro::BuildSubBasinBricksFluxes(SettingsModel& modelSettings) {
                     // Water goes to the outlet
                     flux = new FluxToOutlet();
                     flux->SetType(output.fluxType);
+                    if (!output.lagKernel.empty()) {
+                        flux->SetModifier(ModifierLag::Create(output.lagKernel, output.lagParameters));
+                    }
                     m_subBasin->AttachOutletFlux(flux);
 
                 } else if (m_subBasin->HasBrick(output.target)) {
@@ -390,6 +468,9 @@ void ModelHydro::BuildHydroUnitBricksFluxes(SettingsModel& modelSettings, HydroU
                     flux = new FluxToOutlet();
                     flux->SetAsStatic();
                     flux->SetType(output.fluxType);
+                    if (!output.lagKernel.empty()) {
+                        flux->SetModifier(ModifierLag::Create(output.lagKernel, output.lagParameters));
+                    }
 
                     // From hydro unit to basin: weight by hydro unit area
                     flux->SetFractionUnitArea(unit->GetArea() / m_subBasin->GetArea());
@@ -491,6 +572,9 @@ void ModelHydro::BuildSubBasinSplittersFluxes(SettingsModel& modelSettings) {
                 // Water goes to the outlet
                 flux = new FluxToOutlet();
                 flux->SetType(output.fluxType);
+                if (!output.lagKernel.empty()) {
+                    flux->SetModifier(ModifierLag::Create(output.lagKernel, output.lagParameters));
+                }
                 m_subBasin->AttachOutletFlux(flux);
 
             } else if (m_subBasin->HasBrick(output.target)) {
@@ -532,6 +616,9 @@ void ModelHydro::BuildHydroUnitSplittersFluxes(SettingsModel& modelSettings, Hyd
                 // Water goes to the outlet
                 flux = new FluxToOutlet();
                 flux->SetType(output.fluxType);
+                if (!output.lagKernel.empty()) {
+                    flux->SetModifier(ModifierLag::Create(output.lagKernel, output.lagParameters));
+                }
 
                 // From hydro unit to basin: weight by hydro unit area
                 flux->SetFractionUnitArea(unit->GetArea() / m_subBasin->GetArea());
@@ -794,23 +881,16 @@ bool ModelHydro::ForcingLoaded() {
 }
 
 bool ModelHydro::Run() {
-    if (!InitializeTimeSeries()) {
+    if (!PrepareRun()) {
         return false;
     }
 
-    m_logger.SaveInitialValues();
-
     wxLogMessage(_("Simulation starting."));
 
-    while (!m_timer.IsOver()) {
-        if (!m_processor.ProcessTimeStep()) {
-            wxLogError(_("Failed running the model."));
+    while (!IsOver()) {
+        if (!ProcessTimeStep()) {
             return false;
         }
-        m_logger.SetDate(m_timer.GetDate());
-        m_logger.Record();
-        m_timer.IncrementTime();
-        m_logger.Increment();
         if (!UpdateForcing()) {
             wxLogError(_("Failed updating the forcing data."));
             return false;
@@ -822,17 +902,260 @@ bool ModelHydro::Run() {
     return true;
 }
 
+bool ModelHydro::PrepareRun() {
+    if (!InitializeTimeSeries()) {
+        return false;
+    }
+
+    m_processor.UpdateActiveBricks();
+    m_processor.ResetSolver();
+
+    if (m_boundaryReplay) {
+        PrepareBoundaryReplay();
+    }
+
+    m_logger.SaveInitialValues();
+
+    return true;
+}
+
+bool ModelHydro::EnableBoundaryReplay(bool active) {
+    if (active && !m_processor.SupportsBoundaryReplay()) {
+        return false;
+    }
+    if (active && HasVariableHydroUnitsParameters()) {
+        wxLogError(_("The inputs of the sub basin cannot be replayed as the hydro units have variable parameters."));
+        return false;
+    }
+
+    m_boundaryReplay = active;
+    m_processor.SetBoundaryMode(BoundaryOff);
+    m_processor.ClearBoundaryRecord();
+    m_recordedUnitsParameters.clear();
+    m_recordedUnitsState.clear();
+    m_recordedStartStep = -1;
+
+    return true;
+}
+
+vecDouble ModelHydro::GetHydroUnitsState() {
+    vecDouble state;
+    for (int iUnit = 0; iUnit < m_subBasin->GetHydroUnitsNb(); ++iUnit) {
+        HydroUnit* unit = m_subBasin->GetHydroUnit(iUnit);
+        for (int i = 0; i < unit->GetBricksCount(); ++i) {
+            Brick* brick = unit->GetBrick(i);
+            for (auto container : brick->GetWaterContainers()) {
+                state.push_back(*container->GetContentPointer());
+            }
+            if (brick->IsLandCover()) {
+                state.push_back(dynamic_cast<LandCover*>(brick)->GetAreaFraction());
+            } else if (brick->CanHaveAreaFraction()) {
+                state.push_back(dynamic_cast<SurfaceComponent*>(brick)->GetAreaFraction());
+            }
+        }
+    }
+
+    return state;
+}
+
+bool ModelHydro::HasVariableHydroUnitsParameters() const {
+    for (auto value : m_unitsParameters) {
+        if (IsNaN(value)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ModelHydro::PrepareBoundaryReplay() {
+    // Parameters changing in time cannot be compared between runs.
+    if (HasVariableHydroUnitsParameters()) {
+        wxLogWarning(_("The hydro units have variable parameters: their outputs are not replayed."));
+        m_processor.ClearBoundaryRecord();
+        m_processor.SetBoundaryMode(BoundaryOff);
+        m_recordedUnitsParameters.clear();
+        return;
+    }
+
+    // A record made with other parameters or from another state of the hydro units is useless.
+    int startStep = m_timer.GetTimeStepIndex();
+    vecDouble unitsState = GetHydroUnitsState();
+    if (m_unitsParameters != m_recordedUnitsParameters || startStep != m_recordedStartStep ||
+        unitsState != m_recordedUnitsState) {
+        m_processor.ClearBoundaryRecord();
+        m_recordedUnitsParameters = m_unitsParameters;
+        m_recordedUnitsState = unitsState;
+        m_recordedStartStep = startStep;
+    }
+
+    if (m_processor.HasBoundaryRecordFrom(startStep)) {
+        m_processor.SetBoundaryMode(BoundaryReplay);
+    } else {
+        m_processor.SetBoundaryMode(BoundaryRecord);
+    }
+}
+
+bool ModelHydro::ProcessTimeStep() {
+    if (!m_processor.ProcessTimeStep()) {
+        wxLogError(_("Failed running the model."));
+        return false;
+    }
+    m_logger.SetDate(m_timer.GetDate());
+    m_logger.Record();
+    m_timer.IncrementTime();
+    m_logger.Increment();
+
+    return true;
+}
+
 void ModelHydro::Reset() {
     m_timer.Reset();
     m_logger.Reset();
     m_behavioursManager.Reset();
     m_subBasin->Reset();
+    m_processor.ResetQuiescenceCounters();
+    m_processor.ResetSolver();
 }
 
 void ModelHydro::SaveAsInitialState() {
     m_subBasin->SaveAsInitialState();
 }
 
+int ModelHydro::SaveState() {
+    m_savedStates.push_back(GetState());
+
+    return int(m_savedStates.size()) - 1;
+}
+
+bool ModelHydro::RestoreState(int handle) {
+    if (handle < 0 || handle >= m_savedStates.size()) {
+        wxLogError(_("The state %d does not exist."), handle);
+        return false;
+    }
+
+    return SetState(m_savedStates[handle]);
+}
+
+void ModelHydro::ClearStates() {
+    m_savedStates.clear();
+}
+
+vecDouble ModelHydro::GetState() {
+    BuildStateLayout();
+
+    vecDouble state;
+    state.reserve(GetStateSize());
+    state.push_back(m_timer.GetDate());
+    state.push_back(m_logger.GetCursor());
+    state.push_back(m_behavioursManager.GetCursor());
+    for (int i = 0; i < m_behavioursManager.GetBehavioursNb(); ++i) {
+        state.push_back(m_behavioursManager.GetBehaviour(i)->GetCursor());
+    }
+    for (auto timeSeries : m_timeSeries) {
+        state.push_back(timeSeries->GetCursor());
+    }
+    for (auto content : m_stateContents) {
+        state.push_back(*content);
+    }
+    for (auto landCover : m_stateLandCovers) {
+        state.push_back(landCover->GetAreaFraction());
+    }
+    for (auto surfaceComponent : m_stateSurfaceComponents) {
+        state.push_back(surfaceComponent->GetAreaFraction());
+    }
+    for (auto modifier : m_stateModifiers) {
+        modifier->GetState(state);
+    }
+    wxASSERT(state.size() == GetStateSize());
+
+    return state;
+}
+
+bool ModelHydro::SetState(const vecDouble& state) {
+    BuildStateLayout();
+
+    if (state.size() != GetStateSize()) {
+        wxLogError(_("The saved state does not match the model (the time series might have changed)."));
+        return false;
+    }
+
+    const double* value = state.data();
+    m_timer.SetDate(*value++);
+    m_logger.SetCursor(int(*value++));
+    m_behavioursManager.SetCursor(int(*value++));
+    for (int i = 0; i < m_behavioursManager.GetBehavioursNb(); ++i) {
+        m_behavioursManager.GetBehaviour(i)->SetCursor(int(*value++));
+    }
+    for (auto timeSeries : m_timeSeries) {
+        timeSeries->SetCursor(int(*value++));
+    }
+    for (auto content : m_stateContents) {
+        *content = *value++;
+    }
+
+    // The land covers first, as the fractions of the surface components depend on them.
+    for (auto landCover : m_stateLandCovers) {
+        landCover->SetAreaFraction(*value++);
+    }
+    for (auto surfaceComponent : m_stateSurfaceComponents) {
+        surfaceComponent->SetAreaFraction(*value++);
+    }
+    for (auto modifier : m_stateModifiers) {
+        value = modifier->SetState(value);
+    }
+
+    m_processor.UpdateActiveBricks();
+
+    return true;
+}
+
+void ModelHydro::BuildStateLayout() {
+    // The structure does not change after initialization, so the layout is built once.
+    if (!m_stateContents.empty()) {
+        return;
+    }
+
+    for (int i = 0; i < m_subBasin->GetBricksCount(); ++i) {
+        for (auto container : m_subBasin->GetBrick(i)->GetWaterContainers()) {
+            m_stateContents.push_back(container->GetContentPointer());
+        }
+    }
+    for (int iUnit = 0; iUnit < m_subBasin->GetHydroUnitsNb(); ++iUnit) {
+        HydroUnit* unit = m_subBasin->GetHydroUnit(iUnit);
+        for (int i = 0; i < unit->GetBricksCount(); ++i) {
+            Brick* brick = unit->GetBrick(i);
+            for (auto container : brick->GetWaterContainers()) {
+                m_stateContents.push_back(container->GetContentPointer());
+            }
+            if (brick->IsLandCover()) {
+                auto landCover = dynamic_cast<LandCover*>(brick);
+                wxASSERT(landCover);
+                m_stateLandCovers.push_back(landCover);
+            } else if (brick->CanHaveAreaFraction()) {
+                auto surfaceComponent = dynamic_cast<SurfaceComponent*>(brick);
+                wxASSERT(surfaceComponent);
+                m_stateSurfaceComponents.push_back(surfaceComponent);
+            }
+        }
+    }
+    for (auto flux : m_subBasin->GetOutletFluxes()) {
+        if (flux->HasModifier()) {
+            m_stateModifiers.push_back(flux->GetModifier());
+        }
+    }
+}
+
+int ModelHydro::GetStateSize() {
+    int size = 3 + m_behavioursManager.GetBehavioursNb() + int(m_timeSeries.size());
+    size += int(m_stateContents.size() + m_stateLandCovers.size() + m_stateSurfaceComponents.size());
+    for (auto modifier : m_stateModifiers) {
+        size += modifier->GetStateSize();
+    }
+
+    return size;
+}
+
 bool ModelHydro::DumpOutputs(const string& path) {
     return m_logger.DumpOutputs(path);
 }
@@ -841,6 +1164,14 @@ axd ModelHydro::GetOutletDischarge() {
     return m_logger.GetOutletDischarge();
 }
 
+double ModelHydro::GetSkippedBricksFraction() const {
+    return m_processor.GetSkippedBricksFraction();
+}
+
+double ModelHydro::GetSkippedUnitsFraction() const {
+    return m_processor.GetSkippedUnitsFraction();
+}
+
 double ModelHydro::GetTotalOutletDischarge() {
     return m_logger.GetTotalOutletDischarge();
 }
@@ -906,16 +1237,56 @@ bool ModelHydro::CreateTimeSeries(const string& varName, const axd& time, const
     return true;
 }
 
+bool ModelHydro::CreateTimeSeries(const string& varName, const axd& time, const axi& ids,
+                                  std::shared_ptr<const void> data, bool unitMajor, bool singlePrecision) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, std::move(data), unitMajor, singlePrecision);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelHydro::AddTimeSeriesFromCache(const string& path) {
+    vector<TimeSeries*> vecTimeSeries;
+    if (!TimeSeries::ParseCache(path, vecTimeSeries)) {
+        for (auto timeSeries : vecTimeSeries) {
+            wxDELETE(timeSeries);
+        }
+        return false;
+    }
+
+    for (int i = 0; i < vecTimeSeries.size(); ++i) {
+        if (!AddTimeSeries(vecTimeSeries[i])) {
+            for (int j = i; j < vecTimeSeries.size(); ++j) {
+                wxDELETE(vecTimeSeries[j]);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void ModelHydro::ClearTimeSeries() {
     for (auto ts : m_timeSeries) {
         wxDELETE(ts);
     }
     m_timeSeries.resize(0);
+    m_processor.ClearBoundaryRecord();
 }
 
 bool ModelHydro::AttachTimeSeriesToHydroUnits() {
     wxASSERT(m_subBasin);
 
+    // The recorded inputs of the sub basin depend on the forcing.
+    m_processor.ClearBoundaryRecord();
+
     for (auto timeSeries : m_timeSeries) {
         VariableType type = timeSeries->GetVariableType();
 
@@ -923,7 +1294,7 @@ bool ModelHydro::AttachTimeSeriesToHydroUnits() {
             HydroUnit* unit = m_subBasin->GetHydroUnit(iUnit);
             if (unit->HasForcing(type)) {
                 Forcing* forcing = unit->GetForcing(type);
-                forcing->AttachTimeSeriesData(timeSeries->GetDataPointer(unit->GetId()));
+                timeSeries->AttachForcing(forcing, unit->GetId());
             }
         }
     }
@@ -19,6 +19,18 @@ class ModelHydro : public wxObject {
 
     bool Initialize(SettingsModel& modelSettings, SettingsBasin& basinProp);
 
+    /**
+     * Create a replica of the model. The hydro units are copied instead of being built from the basin settings, the
+     * area fractions and the state of the water containers are copied, and the time series are shared read-only (the
+     * replica only has its own cursors). Behaviours are not supported.
+     *
+     * @param modelSettings The settings of the replica, describing the same structure as the settings of this model
+     * (e.g. a copy of them). The parameters of the replica are bound to them, so they must outlive it.
+     * @return The replica or nullptr on failure. The caller owns the replica, its sub basin (GetSubBasin()) and its
+     * time series copies (ClearTimeSeries()).
+     */
+    ModelHydro* Clone(SettingsModel& modelSettings);
+
     void UpdateParameters(SettingsModel& modelSettings);
 
     bool IsOk();
@@ -27,10 +39,97 @@ class ModelHydro : public wxObject {
 
     bool Run();
 
+    /**
+     * Set the forcing data to the beginning of the modelling period and record the initial values.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool PrepareRun();
+
+    /**
+     * Process the current time step, record the outputs and move to the next time step. The forcing data are not
+     * advanced (see UpdateForcing()).
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool ProcessTimeStep();
+
+    /**
+     * Advance the forcing data by one time step.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool UpdateForcing();
+
+    bool IsOver() {
+        return m_timer.IsOver();
+    }
+
     void Reset();
 
     void SaveAsInitialState();
 
+    /**
+     * Save the full state of the model in memory: the content of all the containers, the area fractions, the date
+     * and the cursors of the forcing, the behaviours and the logger. The state can then be restored at any time, for
+     * example to continue a simulation from a warm state.
+     *
+     * @return The handle of the saved state.
+     */
+    int SaveState();
+
+    /**
+     * Restore a state saved by SaveState(). The model structure and the time series must not have changed since.
+     *
+     * @param handle The handle of the saved state.
+     * @return True if successful, false otherwise.
+     */
+    bool RestoreState(int handle);
+
+    /**
+     * Release all the saved states. The previous handles become invalid.
+     */
+    void ClearStates();
+
+    /**
+     * Get a copy of the full state of the model (see SaveState()). The state can be applied to any model having the
+     * same structure and time series, such as a replica created by Clone().
+     *
+     * @return The state buffer.
+     */
+    vecDouble GetState();
+
+    /**
+     * Apply a state obtained by GetState().
+     *
+     * @param state The state buffer.
+     * @return True if successful, false otherwise.
+     */
+    bool SetState(const vecDouble& state);
+
+    /**
+     * Record the inputs of the sub basin bricks coming from the hydro units (and the contribution of the hydro units
+     * to the outlet) during the runs, and replay them in the following runs as long as the parameters of the hydro
+     * units and the forcing are unchanged and the runs start at the same time step from the same hydro units state.
+     * Only the sub basin bricks are then simulated, which speeds up the calibration of their parameters. The hydro
+     * units are not updated during a replayed run: their logger outputs are not updated (they keep the values of
+     * the previous run) and their states are not meaningful. Hydro units with variable parameters are never
+     * replayed.
+     *
+     * @param active True to activate the record and replay, false to deactivate it and release the record.
+     * @return True if successful, false if the model does not support it.
+     */
+    bool EnableBoundaryReplay(bool active = true);
+
+    /**
+     * Check if the current (or last) run replays the recorded inputs of the sub basin.
+     *
+     * @return True if the hydro units are not simulated.
+     */
+    bool IsReplayingBoundary() const {
+        return m_processor.GetBoundaryMode() == BoundaryReplay;
+    }
+
     bool DumpOutputs(const string& path);
 
     axd GetOutletDischarge();
@@ -43,6 +142,10 @@ class ModelHydro : public wxObject {
 
     double GetTotalSnowStorageChanges();
 
+    double GetSkippedBricksFraction() const;
+
+    double GetSkippedUnitsFraction() const;
+
     bool AddTimeSeries(TimeSeries* timeSeries);
 
     bool AddBehaviour(Behaviour* behaviour);
@@ -53,6 +156,23 @@ class ModelHydro : public wxObject {
 
     bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data);
 
+    /**
+     * Create a time series referencing an existing block of values (see TimeSeries::Create()) and add it to the
+     * model.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, std::shared_ptr<const void> data,
+                          bool unitMajor, bool singlePrecision = false);
+
+    /**
+     * Add the time series of a binary forcing cache (see TimeSeries::WriteCache()).
+     *
+     * @param path The path of the cache file.
+     * @return True if successful, false otherwise.
+     */
+    bool AddTimeSeriesFromCache(const string& path);
+
     void ClearTimeSeries();
 
     bool AttachTimeSeriesToHydroUnits();
@@ -89,10 +209,37 @@ class ModelHydro : public wxObject {
     BehavioursManager m_behavioursManager;
     ParametersUpdater m_parametersUpdater;
     vector<TimeSeries*> m_timeSeries;
+    vector<vecDouble> m_savedStates;
+    vecDoublePt m_stateContents;
+    vector<LandCover*> m_stateLandCovers;
+    vector<SurfaceComponent*> m_stateSurfaceComponents;
+    vector<Modifier*> m_stateModifiers;
+    bool m_boundaryReplay;
+    vector<float> m_unitsParameters;
+    vector<float> m_recordedUnitsParameters;
+    vecDouble m_recordedUnitsState;
+    int m_recordedStartStep;
 
   private:
     void BuildModelStructure(SettingsModel& modelSettings);
 
+    void InitializeComponents(SettingsModel& modelSettings);
+
+    /**
+     * Get the values of all the parameters of the hydro units. The variable parameters get NaN, which never
+     * compares equal.
+     */
+    static vector<float> GetHydroUnitsParameterValues(SettingsModel& modelSettings);
+
+    /**
+     * Get the contents and area fractions of the hydro units, which determine their outputs with the parameters.
+     */
+    vecDouble GetHydroUnitsState();
+
+    bool HasVariableHydroUnitsParameters() const;
+
+    void PrepareBoundaryReplay();
+
     void CreateSubBasinComponents(SettingsModel& modelSettings);
 
     void CreateHydroUnitsComponents(SettingsModel& modelSettings);
@@ -127,7 +274,9 @@ class ModelHydro : public wxObject {
 
     bool InitializeTimeSeries();
 
-    bool UpdateForcing();
+    void BuildStateLayout();
+
+    int GetStateSize();
 };
 
 #endif  // HYDROBRICKS_MODEL_HYDRO_H
@@ -0,0 +1,263 @@
+#include "ModelNetwork.h"
+
+ModelNetwork::ModelNetwork()
+    : m_threadPool(nullptr) {}
+
+ModelNetwork::~ModelNetwork() {
+    for (auto model : m_models) {
+        SubBasin* subBasin = model->GetSubBasin();
+        wxDELETE(model);
+        wxDELETE(subBasin);
+    }
+    for (auto settings : m_settings) {
+        wxDELETE(settings);
+    }
+    for (auto connector : m_connectors) {
+        wxDELETE(connector);
+    }
+    for (auto timeSeries : m_ownedTimeSeries) {
+        wxDELETE(timeSeries);
+    }
+    wxDELETE(m_threadPool);
+}
+
+bool ModelNetwork::AddSubBasin(SettingsModel& modelSettings, SettingsBasin& basinSettings) {
+    if (!m_levels.empty()) {
+        wxLogError(_("Sub basins cannot be added once the network is initialized."));
+        return false;
+    }
+
+    // The sub basins are processed concurrently, not their hydro units.
+    auto settings = new SettingsModel(modelSettings);
+    settings->SetThreadsNb(1);
+
+    auto model = new ModelHydro();
+    bool isOk = model->InitializeWithBasin(*settings, basinSettings);
+
+    if (isOk && !m_models.empty()) {
+        TimeMachine* timer = model->GetTimeMachine();
+        TimeMachine* ref = m_models[0]->GetTimeMachine();
+        if (timer->GetStart() != ref->GetStart() || timer->GetEnd() != ref->GetEnd() ||
+            *timer->GetTimeStepPointer() != *ref->GetTimeStepPointer()) {
+            wxLogError(_("All the sub basins of the network must share the same modelling period and time step."));
+            isOk = false;
+        }
+    }
+
+    // The network is left unchanged by a rejected sub basin.
+    if (!isOk) {
+        SubBasin* subBasin = model->GetSubBasin();
+        wxDELETE(model);
+        wxDELETE(subBasin);
+        wxDELETE(settings);
+        return false;
+    }
+
+    m_settings.push_back(settings);
+    m_models.push_back(model);
+    m_downstream.push_back(-1);
+
+    return true;
+}
+
+bool ModelNetwork::Connect(int upstream, int downstream) {
+    int subBasinsNb = int(m_models.size());
+    if (upstream < 0 || upstream >= subBasinsNb || downstream < 0 || downstream >= subBasinsNb) {
+        wxLogError(_("The sub basins %d and %d cannot be connected (%d sub basins)."), upstream, downstream,
+                   subBasinsNb);
+        return false;
+    }
+    if (upstream == downstream) {
+        wxLogError(_("A sub basin cannot be connected to itself."));
+        return false;
+    }
+    if (m_downstream[upstream] >= 0) {
+        wxLogError(_("The sub basin %d is already connected to a downstream sub basin."), upstream);
+        return false;
+    }
+    if (!m_levels.empty()) {
+        wxLogError(_("Sub basins cannot be connected once the network is initialized."));
+        return false;
+    }
+
+    auto connector = new Connector();
+    m_connectors.push_back(connector);
+    connector->Connect(m_models[upstream]->GetSubBasin(), m_models[downstream]->GetSubBasin());
+    m_downstream[upstream] = downstream;
+
+    return true;
+}
+
+bool ModelNetwork::Initialize(int threadsNb) {
+    if (m_models.empty()) {
+        wxLogError(_("The network has no sub basin."));
+        return false;
+    }
+    if (!m_levels.empty()) {
+        wxLogError(_("The network was already initialized."));
+        return false;
+    }
+
+    // Level of a sub basin: length of the longest path from the sources (Kahn's algorithm).
+    int subBasinsNb = int(m_models.size());
+    vecInt upstreamNb(subBasinsNb, 0);
+    for (auto downstream : m_downstream) {
+        if (downstream >= 0) {
+            upstreamNb[downstream]++;
+        }
+    }
+
+    vecInt level;
+    for (int i = 0; i < subBasinsNb; ++i) {
+        if (upstreamNb[i] == 0) {
+            level.push_back(i);
+        }
+    }
+
+    int sortedNb = 0;
+    while (!level.empty()) {
+        sortedNb += int(level.size());
+        vecInt nextLevel;
+        for (auto i : level) {
+            int downstream = m_downstream[i];
+            if (downstream >= 0 && --upstreamNb[downstream] == 0) {
+                nextLevel.push_back(downstream);
+            }
+        }
+        m_levels.push_back(level);
+        level = nextLevel;
+    }
+
+    if (sortedNb != subBasinsNb) {
+        wxLogError(_("The sub basins network contains a cycle."));
+        m_levels.clear();
+        return false;
+    }
+
+    size_t maxWidth = 0;
+    for (const auto& subBasins : m_levels) {
+        maxWidth = std::max(maxWidth, subBasins.size());
+    }
+    threadsNb = wxMin(threadsNb, int(maxWidth));
+    if (threadsNb > 1) {
+        m_threadPool = new ThreadPool(threadsNb);
+    }
+
+    return true;
+}
+
+bool ModelNetwork::AddTimeSeries(TimeSeries* timeSeries) {
+    for (auto model : m_models) {
+        if (!model->AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelNetwork::CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, data);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelNetwork::CreateTimeSeries(const string& varName, const axd& time, const axi& ids,
+                                    std::shared_ptr<const void> data, bool unitMajor, bool singlePrecision) {
+    try {
+        TimeSeries* timeSeries = TimeSeries::Create(varName, time, ids, std::move(data), unitMajor, singlePrecision);
+        m_ownedTimeSeries.push_back(timeSeries);
+        if (!AddTimeSeries(timeSeries)) {
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("An exception occurred during timeseries creation: %s."), e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool ModelNetwork::AttachTimeSeriesToHydroUnits() {
+    for (auto model : m_models) {
+        if (!model->AttachTimeSeriesToHydroUnits()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ModelNetwork::Run() {
+    if (m_levels.empty()) {
+        wxLogError(_("The network must be initialized before running."));
+        return false;
+    }
+
+    for (auto model : m_models) {
+        if (!model->PrepareRun()) {
+            return false;
+        }
+    }
+
+    wxLogMessage(_("Network simulation starting."));
+
+    // The forcing data are shared: the sub basins are advanced once per time step, level after level.
+    vector<char> success(m_models.size());
+    while (!m_models[0]->IsOver()) {
+        for (const auto& subBasins : m_levels) {
+            auto processSubBasin = [this, &subBasins, &success](int i) {
+                int index = subBasins[i];
+                success[index] = m_models[index]->ProcessTimeStep();
+            };
+            if (m_threadPool) {
+                m_threadPool->ParallelFor(int(subBasins.size()), processSubBasin);
+            } else {
+                for (int i = 0; i < subBasins.size(); ++i) {
+                    processSubBasin(i);
+                }
+            }
+            for (auto index : subBasins) {
+                if (!success[index]) {
+                    return false;
+                }
+            }
+        }
+        if (!m_models[0]->UpdateForcing()) {
+            wxLogError(_("Failed updating the forcing data."));
+            return false;
+        }
+    }
+
+    wxLogMessage(_("Network simulation completed."));
+
+    return true;
+}
+
+void ModelNetwork::Reset() {
+    for (auto model : m_models) {
+        model->Reset();
+    }
+}
+
+axxd ModelNetwork::GetOutletDischarges() {
+    if (m_models.empty()) {
+        return {};
+    }
+
+    axxd discharges(m_models[0]->GetOutletDischarge().size(), m_models.size());
+    for (int i = 0; i < m_models.size(); ++i) {
+        discharges.col(i) = m_models[i]->GetOutletDischarge();
+    }
+
+    return discharges;
+}
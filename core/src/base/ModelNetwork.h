@@ -0,0 +1,111 @@
+#ifndef HYDROBRICKS_MODEL_NETWORK_H
+#define HYDROBRICKS_MODEL_NETWORK_H
+
+#include "Connector.h"
+#include "Includes.h"
+#include "ModelHydro.h"
+#include "SettingsBasin.h"
+#include "SettingsModel.h"
+#include "ThreadPool.h"
+
+/**
+ * Network of sub basins, each simulated by its own model, connected by connectors into a directed acyclic graph.
+ * The outlet discharge of a sub basin is added to the outlet of its downstream sub basin at the same time step. The
+ * sub basins are processed by levels (topological wavefronts): the sub basins of a level only depend on those of
+ * the previous levels and are processed concurrently when multiple threads are used.
+ */
+class ModelNetwork : public wxObject {
+  public:
+    explicit ModelNetwork();
+
+    ~ModelNetwork() override;
+
+    /**
+     * Add a sub basin to the network. Its index is its order of addition.
+     *
+     * @param modelSettings The model settings (structure and parameter values) of the sub basin. They are copied.
+     * @param basinSettings The basin settings of the sub basin.
+     * @return True if successful, false otherwise.
+     */
+    bool AddSubBasin(SettingsModel& modelSettings, SettingsBasin& basinSettings);
+
+    /**
+     * Connect the outlet of a sub basin to its downstream sub basin. A sub basin can have a single downstream sub
+     * basin but multiple upstream ones.
+     *
+     * @param upstream The index of the upstream sub basin.
+     * @param downstream The index of the downstream sub basin.
+     * @return True if successful, false otherwise.
+     */
+    bool Connect(int upstream, int downstream);
+
+    /**
+     * Sort the sub basins by levels and create the threads. Must be called once the network is complete.
+     *
+     * @param threadsNb The number of threads to process the sub basins of a level concurrently.
+     * @return True if successful, false otherwise (e.g., if the network contains a cycle).
+     */
+    bool Initialize(int threadsNb = 1);
+
+    /**
+     * Add a time series to all sub basins. The time series is not owned by the network and must contain the data
+     * of the hydro units of all the sub basins.
+     *
+     * @param timeSeries The time series to add.
+     * @return True if successful, false otherwise.
+     */
+    bool AddTimeSeries(TimeSeries* timeSeries);
+
+    /**
+     * Create a time series owned by the network and add it to all sub basins.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, const axxd& data);
+
+    /**
+     * Create a time series owned by the network referencing an existing block of values (see TimeSeries::Create())
+     * and add it to all sub basins.
+     *
+     * @return True if successful, false otherwise.
+     */
+    bool CreateTimeSeries(const string& varName, const axd& time, const axi& ids, std::shared_ptr<const void> data,
+                          bool unitMajor, bool singlePrecision = false);
+
+    bool AttachTimeSeriesToHydroUnits();
+
+    bool Run();
+
+    void Reset();
+
+    /**
+     * Get the outlet discharge of all sub basins (including the inflow from the upstream sub basins).
+     *
+     * @return The discharge as a matrix of [time steps x sub basins].
+     */
+    axxd GetOutletDischarges();
+
+    int GetSubBasinsNb() const {
+        return int(m_models.size());
+    }
+
+    int GetLevelsNb() const {
+        return int(m_levels.size());
+    }
+
+    ModelHydro* GetModel(int index) {
+        wxASSERT(index < m_models.size());
+        return m_models[index];
+    }
+
+  protected:
+    vector<SettingsModel*> m_settings;
+    vector<ModelHydro*> m_models;
+    vector<Connector*> m_connectors;
+    vecInt m_downstream;
+    vector<vecInt> m_levels;
+    vector<TimeSeries*> m_ownedTimeSeries;
+    ThreadPool* m_threadPool;
+};
+
+#endif  // HYDROBRICKS_MODEL_NETWORK_H
@@ -1,26 +1,95 @@
 #include "Processor.h"
 
+#include <unordered_map>
+#include <unordered_set>
+
+#include "FluxForcing.h"
+#include "IceContainer.h"
 #include "ModelHydro.h"
 #include "SubBasin.h"
 
 Processor::Processor()
     : m_solver(nullptr),
       m_model(nullptr),
+      m_threadPool(nullptr),
+      m_threadsNb(1),
+      m_timeStepInDays(1),
+      m_inlineRateKernels(true),
+      m_skipQuiescentBricks(false),
+      m_analyticalLinearStorages(false),
       m_solvableConnectionsNb(0),
-      m_directConnectionsNb(0) {}
+      m_directConnectionsNb(0),
+      m_bricksNb(0),
+      m_skippedBricksNb(0),
+      m_unitsNb(0),
+      m_skippedUnitsNb(0),
+      m_boundaryMode(BoundaryOff),
+      m_boundaryStepSize(0),
+      m_boundaryStep(0),
+      m_boundaryPass(0) {}
 
 Processor::~Processor() {
     wxDELETE(m_solver);
+    wxDELETE(m_threadPool);
 }
 
 void Processor::Initialize(const SolverSettings& solverSettings) {
+    m_threadsNb = wxMax(1, solverSettings.threadsNb);
+    if (m_threadsNb > 1) {
+        m_threadPool = new ThreadPool(m_threadsNb);
+        DeferInstantaneousFluxesToSubBasin();
+    }
+
     m_solver = Solver::Factory(solverSettings);
     m_solver->Connect(this);
+    m_inlineRateKernels = solverSettings.inlineRateKernels;
+    m_skipQuiescentBricks = solverSettings.skipQuiescentBricks;
+    m_analyticalLinearStorages = solverSettings.analyticalLinearStorages;
     ConnectToElementsToSolve();
+    BuildProcessingTables();
+}
+
+void Processor::BuildProcessingTables() {
+    BuildRateKernels();
+    BuildConstraintTable();
+    BuildBoundaryInputs();
+    if (m_skipQuiescentBricks) {
+        BuildActivityInputs();
+    }
     m_solver->InitializeContainers();
+    if (m_analyticalLinearStorages) {
+        for (auto brick : m_iterableBricks) {
+            brick->SetAnalyticalIntegration(brick->HasOnlyLinearOutflows());
+        }
+    }
     m_changeRatesNoSolver = axd::Zero(m_directConnectionsNb);
 }
 
+void Processor::UpdateActiveBricks() {
+    if (m_solver == nullptr || CollectNullBricks() == m_nullBricks) {
+        return;
+    }
+
+    ConnectToElementsToSolve();
+    BuildProcessingTables();
+}
+
+vector<Brick*> Processor::CollectNullBricks() {
+    SubBasin* basin = m_model->GetSubBasin();
+
+    vector<Brick*> nullBricks;
+    for (int iUnit = 0; iUnit < basin->GetHydroUnitsNb(); ++iUnit) {
+        HydroUnit* unit = basin->GetHydroUnit(iUnit);
+        for (int iBrick = 0; iBrick < unit->GetBricksCount(); ++iBrick) {
+            if (unit->GetBrick(iBrick)->IsNull()) {
+                nullBricks.push_back(unit->GetBrick(iBrick));
+            }
+        }
+    }
+
+    return nullBricks;
+}
+
 void Processor::SetModel(ModelHydro* model) {
     m_model = model;
 }
@@ -28,34 +97,88 @@ void Processor::SetModel(ModelHydro* model) {
 void Processor::ConnectToElementsToSolve() {
     SubBasin* basin = m_model->GetSubBasin();
 
+    // Restore the local storage of the state variables before rebuilding the contiguous one
+    for (auto container : m_stateContainers) {
+        container->UnlinkDynamicContentChange();
+    }
+    m_stateContainers.clear();
+    m_iterableBricks.clear();
+    m_directBricks.clear();
+    m_directBricksStart.clear();
+    m_solvableConnectionsNb = 0;
+    m_directConnectionsNb = 0;
+
+    // The bricks with a null area are not processed. Their outgoing fluxes are nulled as they will not be updated,
+    // but the water already lagged by their modifiers is kept, as this can happen during a run.
+    m_nullBricks = CollectNullBricks();
+    for (auto brick : m_nullBricks) {
+        for (auto process : brick->GetProcesses()) {
+            for (auto flux : process->GetOutputFluxes()) {
+                flux->ResetAmount();
+            }
+        }
+    }
+
+    vector<ProcessingBlock> unitRanges;
     for (int iUnit = 0; iUnit < basin->GetHydroUnitsNb(); ++iUnit) {
         HydroUnit* unit = basin->GetHydroUnit(iUnit);
+
+        ProcessingBlock unitRange;
+        unitRange.unitsStart = iUnit;
+        unitRange.unitsEnd = iUnit + 1;
+        unitRange.bricksStart = int(m_iterableBricks.size());
+        unitRange.ratesStart = m_solvableConnectionsNb;
+        unitRange.stateVariablesStart = int(m_stateContainers.size());
+        unitRange.directRatesStart = m_directConnectionsNb;
+
+        m_directBricksStart.push_back(int(m_directBricks.size()));
+
         bool solverRequired = false;
         for (int iBrick = 0; iBrick < unit->GetBricksCount(); ++iBrick) {
             Brick* brick = unit->GetBrick(iBrick);
 
             // Add the bricks that need a solver and all their children
             if (brick->NeedsSolver() || solverRequired) {
-                m_iterableBricks.push_back(brick);
                 solverRequired = true;
+                if (brick->IsNull()) {
+                    continue;
+                }
+                m_iterableBricks.push_back(brick);
 
                 // Get state variables from bricks
-                vecDoublePt bricksValues = brick->GetDynamicContentChanges();
-                StoreStateVariableChanges(bricksValues);
-
-                // Get state variables from processes
-                vecDoublePt processValues = brick->GetStateVariableChangesFromProcesses();
-                StoreStateVariableChanges(processValues);
+                StoreStateVariables(brick);
 
                 // Count connections
                 m_solvableConnectionsNb += brick->GetProcessesConnectionsNb();
             } else {
+                if (brick->IsNull()) {
+                    continue;
+                }
+                m_directBricks.push_back(brick);
+
                 // Count connections
                 m_directConnectionsNb += brick->GetProcessesConnectionsNb();
             }
         }
+
+        unitRange.bricksEnd = int(m_iterableBricks.size());
+        unitRange.stateVariablesEnd = int(m_stateContainers.size());
+        unitRanges.push_back(unitRange);
     }
 
+    m_directBricksStart.push_back(int(m_directBricks.size()));
+    m_unitRanges = unitRanges;
+    CreateUnitBlocks(unitRanges);
+
+    m_subBasinBlock = ProcessingBlock();
+    m_subBasinBlock.unitsStart = basin->GetHydroUnitsNb();
+    m_subBasinBlock.unitsEnd = basin->GetHydroUnitsNb();
+    m_subBasinBlock.bricksStart = int(m_iterableBricks.size());
+    m_subBasinBlock.ratesStart = m_solvableConnectionsNb;
+    m_subBasinBlock.stateVariablesStart = int(m_stateContainers.size());
+    m_subBasinBlock.directRatesStart = m_directConnectionsNb;
+    m_subBasinBlock.isSubBasin = true;
+
     for (int iBrick = 0; iBrick < basin->GetBricksCount(); ++iBrick) {
         Brick* brick = basin->GetBrick(iBrick);
 
@@ -63,68 +186,607 @@ void Processor::ConnectToElementsToSolve() {
         m_iterableBricks.push_back(brick);
 
         // Get state variables from bricks
-        vecDoublePt bricksValues = brick->GetDynamicContentChanges();
-        StoreStateVariableChanges(bricksValues);
-
-        // Get state variables from processes
-        vecDoublePt processValues = brick->GetStateVariableChangesFromProcesses();
-        StoreStateVariableChanges(processValues);
+        StoreStateVariables(brick);
 
         // Count connections
         m_solvableConnectionsNb += brick->GetProcessesConnectionsNb();
     }
-}
 
-void Processor::StoreStateVariableChanges(vecDoublePt& values) {
-    if (!values.empty()) {
-        for (auto const& value : values) {
-            m_stateVariableChanges.push_back(value);
-        }
+    m_subBasinBlock.bricksEnd = int(m_iterableBricks.size());
+    m_subBasinBlock.stateVariablesEnd = int(m_stateContainers.size());
+
+    // Move the state variables to a contiguous storage
+    m_stateVariableChanges = axd::Zero(int(m_stateContainers.size()));
+    for (int i = 0; i < m_stateContainers.size(); ++i) {
+        m_stateContainers[i]->LinkDynamicContentChange(&m_stateVariableChanges(i));
     }
 }
 
-int Processor::GetNbStateVariables() {
-    return int(m_stateVariableChanges.size());
-}
+void Processor::CreateUnitBlocks(const vector<ProcessingBlock>& unitRanges) {
+    m_unitBlocks.clear();
 
-bool Processor::ProcessTimeStep() {
-    wxASSERT(m_model);
+    int unitsNb = int(unitRanges.size());
+    if (unitsNb == 0) {
+        return;
+    }
+
+    // Use more blocks than threads to balance the load between the threads.
+    int blocksNb = 1;
+    if (m_threadsNb > 1) {
+        blocksNb = wxMin(unitsNb, 4 * m_threadsNb);
+    }
+
+    for (int iBlock = 0; iBlock < blocksNb; ++iBlock) {
+        int first = int((long long)iBlock * unitsNb / blocksNb);
+        int last = int((long long)(iBlock + 1) * unitsNb / blocksNb) - 1;
 
+        ProcessingBlock block = unitRanges[first];
+        block.unitsEnd = unitRanges[last].unitsEnd;
+        block.bricksEnd = unitRanges[last].bricksEnd;
+        block.stateVariablesEnd = unitRanges[last].stateVariablesEnd;
+        m_unitBlocks.push_back(block);
+    }
+}
+
+void Processor::DeferInstantaneousFluxesToSubBasin() {
     SubBasin* basin = m_model->GetSubBasin();
 
-    // Process the bricks that do not need a solver.
-    int ptIndex = 0;
+    // Sorted by hydro unit to sum the amounts in the same order as in the serial processing.
     for (int iUnit = 0; iUnit < basin->GetHydroUnitsNb(); ++iUnit) {
         HydroUnit* unit = basin->GetHydroUnit(iUnit);
-        for (int iSplitter = 0; iSplitter < unit->GetSplittersCount(); ++iSplitter) {
-            Splitter* splitter = unit->GetSplitter(iSplitter);
-            splitter->Compute();
-        }
         for (int iBrick = 0; iBrick < unit->GetBricksCount(); ++iBrick) {
-            Brick* brick = unit->GetBrick(iBrick);
-            if (brick->NeedsSolver()) {
+            for (auto process : unit->GetBrick(iBrick)->GetProcesses()) {
+                for (auto flux : process->GetOutputFluxes()) {
+                    if (!flux->IsInstantaneous()) {
+                        continue;
+                    }
+                    auto instantaneousFlux = dynamic_cast<FluxToBrickInstantaneous*>(flux);
+                    wxASSERT(instantaneousFlux);
+                    if (unit->HasBrick(instantaneousFlux->GetTargetBrick()->GetName())) {
+                        continue;
+                    }
+                    instantaneousFlux->DeferTransfer();
+                    m_deferredFluxes.push_back(instantaneousFlux);
+                }
+            }
+        }
+    }
+}
+
+void Processor::TransferDeferredFluxes() {
+    for (auto flux : m_deferredFluxes) {
+        flux->TransferPendingAmount();
+    }
+}
+
+void Processor::BuildRateKernels() {
+    m_rateKernels.clear();
+    m_rateKernels.reserve(m_solvableConnectionsNb);
+    for (auto brick : m_iterableBricks) {
+        for (auto process : brick->GetProcesses()) {
+            RateKernel kernel = process->GetRateKernel();
+            if (!m_inlineRateKernels || process->GetConnectionsNb() != 1) {
+                kernel.type = RateKernelType::Generic;
+            }
+            for (int i = 0; i < process->GetConnectionsNb(); ++i) {
+                m_rateKernels.push_back(kernel);
+            }
+        }
+    }
+    wxASSERT(m_rateKernels.size() == m_solvableConnectionsNb);
+}
+
+void Processor::BuildConstraintTable() {
+    ConstraintTable& table = m_constraintTable;
+    table.constraints.clear();
+    table.rows.clear();
+    table.staticInputs.clear();
+    table.bricksStart.clear();
+
+    // Rows of the outgoing fluxes in the change rates vector
+    std::unordered_map<Flux*, int> fluxRows;
+    int iRate = 0;
+    for (auto brick : m_iterableBricks) {
+        for (auto process : brick->GetProcesses()) {
+            for (int i = 0; i < process->GetConnectionsNb(); ++i) {
+                fluxRows[process->GetOutputFluxes()[i]] = iRate++;
+            }
+        }
+    }
+    wxASSERT(iRate == m_solvableConnectionsNb);
+
+    for (auto brick : m_iterableBricks) {
+        table.bricksStart.push_back(int(table.constraints.size()));
+
+        // The secondary containers (e.g., snow, ice) are constrained before the main one they feed.
+        vector<WaterContainer*> containers = brick->GetWaterContainers();
+        for (auto it = containers.rbegin(); it != containers.rend(); ++it) {
+            WaterContainer* container = *it;
+            if (container->IsInfiniteStorage()) {
                 continue;
             }
-            if (brick->IsNull()) {
+
+            ContainerConstraint constraint;
+            constraint.container = container;
+            constraint.ice = dynamic_cast<IceContainer*>(container);
+            constraint.capacity = container->GetMaximumCapacityPointer();
+
+            constraint.outputsStart = int(table.rows.size());
+            for (auto process : brick->GetProcesses()) {
+                if (process->GetWaterContainer() != container) {
+                    continue;
+                }
+                for (auto flux : process->GetOutputFluxes()) {
+                    auto row = fluxRows.find(flux);
+                    if (row != fluxRows.end()) {
+                        table.rows.push_back(row->second);
+                    }
+                }
+            }
+            constraint.outputsEnd = int(table.rows.size());
+
+            constraint.inputsStart = int(table.rows.size());
+            constraint.staticInputsStart = int(table.staticInputs.size());
+            for (auto flux : container->GetInputFluxes()) {
+                if (flux->IsInstantaneous()) {
+                    ConstraintStaticInput input;
+                    input.amount = flux->GetAmountPointer();
+                    table.staticInputs.push_back(input);
+                    continue;
+                }
+                if (flux->IsForcing()) {
+                    ConstraintStaticInput input;
+                    input.forcing = dynamic_cast<FluxForcing*>(flux)->GetForcing();
+                    wxASSERT(input.forcing);
+                    table.staticInputs.push_back(input);
+                    continue;
+                }
+                if (flux->IsStatic()) {
+                    ConstraintStaticInput input;
+                    input.amount = flux->GetAmountPointer();
+                    table.staticInputs.push_back(input);
+                    continue;
+                }
+                // Fluxes from the bricks without solver have no rate at this stage.
+                auto row = fluxRows.find(flux);
+                if (row != fluxRows.end()) {
+                    table.rows.push_back(row->second);
+                }
+            }
+            constraint.inputsEnd = int(table.rows.size());
+            constraint.staticInputsEnd = int(table.staticInputs.size());
+
+            if (container->HasOverflow()) {
+                auto row = fluxRows.find(container->GetOverflow()->GetOutputFluxes()[0]);
+                if (row == fluxRows.end()) {
+                    throw ShouldNotHappen();
+                }
+                constraint.overflowRow = row->second;
+            }
+
+            table.constraints.push_back(constraint);
+        }
+    }
+    table.bricksStart.push_back(int(table.constraints.size()));
+}
+
+void Processor::BuildBoundaryInputs() {
+    m_boundaryInputs.clear();
+    m_boundaryOutletFluxes.clear();
+
+    // Fluxes originating in the sub basin; the other inputs of the sub basin come from the hydro units.
+    std::unordered_set<Flux*> subBasinFluxes;
+    for (int iBrick = m_subBasinBlock.bricksStart; iBrick < m_subBasinBlock.bricksEnd; ++iBrick) {
+        for (auto process : m_iterableBricks[iBrick]->GetProcesses()) {
+            for (auto flux : process->GetOutputFluxes()) {
+                subBasinFluxes.insert(flux);
+            }
+        }
+    }
+
+    for (int iBrick = m_subBasinBlock.bricksStart; iBrick < m_subBasinBlock.bricksEnd; ++iBrick) {
+        for (auto container : m_iterableBricks[iBrick]->GetWaterContainers()) {
+            BoundaryInput input;
+            input.container = container;
+            for (auto flux : container->GetInputFluxes()) {
+                // The instantaneous fluxes are accounted for by the static content change.
+                if (flux->IsInstantaneous() || flux->IsForcing() || subBasinFluxes.count(flux) > 0) {
+                    continue;
+                }
+                input.fluxes.push_back(flux);
+            }
+            for (int i = m_constraintTable.bricksStart[iBrick]; i < m_constraintTable.bricksStart[iBrick + 1]; ++i) {
+                const ContainerConstraint& constraint = m_constraintTable.constraints[i];
+                if (constraint.container != container) {
+                    continue;
+                }
+                for (int iRow = constraint.inputsStart; iRow < constraint.inputsEnd; ++iRow) {
+                    int row = m_constraintTable.rows[iRow];
+                    if (row < m_subBasinBlock.ratesStart) {
+                        input.rows.push_back(row);
+                    }
+                }
+            }
+            m_boundaryInputs.push_back(input);
+        }
+    }
+
+    for (auto flux : m_model->GetSubBasin()->GetOutletFluxes()) {
+        if (subBasinFluxes.count(flux) == 0) {
+            m_boundaryOutletFluxes.push_back(flux);
+        }
+    }
+}
+
+bool Processor::SupportsBoundaryReplay() {
+    wxASSERT(m_solver);
+    if (!m_solver->HasFixedStages()) {
+        wxLogError(_("The inputs of the sub basin cannot be replayed with an adaptive or implicit solver."));
+        return false;
+    }
+    for (const auto& input : m_boundaryInputs) {
+        if (input.container->HasMaximumCapacity() && !input.container->HasOverflow()) {
+            wxLogError(_("The inputs of the sub basin cannot be replayed as a sub basin brick can limit them."));
+            return false;
+        }
+    }
+    for (auto flux : m_boundaryOutletFluxes) {
+        if (flux->HasModifier()) {
+            wxLogError(_("The inputs of the sub basin cannot be replayed as the hydro units outputs are lagged."));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Processor::HasBoundaryRecordFrom(int timeStep) const {
+    if (timeStep < 0 || timeStep >= m_boundaryStepsRecorded.size()) {
+        return false;
+    }
+    for (int i = timeStep; i < m_boundaryStepsRecorded.size(); ++i) {
+        if (!m_boundaryStepsRecorded[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Processor::ClearBoundaryRecord() {
+    m_boundaryRecord.clear();
+    m_boundaryStepsRecorded.clear();
+    m_boundaryStepSize = 0;
+}
+
+int Processor::GetBoundaryPassSize() const {
+    // Per container: static change, sum of the incoming amounts and sum of the incoming rates of every column.
+    return int(m_boundaryInputs.size() * (2 + m_solver->GetChangeRates()->cols())) + 1;
+}
+
+void Processor::RecordBoundaryInputs() {
+    const axxd& rates = *m_solver->GetChangeRates();
+
+    // The amounts are summed in the order used by the sub basin so that the replay gives the same results.
+    for (const auto& input : m_boundaryInputs) {
+        m_boundaryStepValues.push_back(input.container->GetStaticContentChange());
+        double amount = 0;
+        for (auto flux : input.fluxes) {
+            amount += flux->GetAmount();
+        }
+        m_boundaryStepValues.push_back(amount);
+        for (int col = 0; col < rates.cols(); ++col) {
+            double rate = 0;
+            for (auto row : input.rows) {
+                rate += rates(row, col);
+            }
+            m_boundaryStepValues.push_back(rate);
+        }
+    }
+
+    double outlet = 0;
+    for (auto flux : m_boundaryOutletFluxes) {
+        outlet += flux->GetAmount();
+    }
+    m_boundaryStepValues.push_back(outlet);
+}
+
+/**
+ * Assign the sum of the amounts to the first flux and null the others.
+ */
+static inline void SetSummedAmount(const vector<Flux*>& fluxes, double amount) {
+    for (int i = 0; i < fluxes.size(); ++i) {
+        *fluxes[i]->GetAmountPointer() = i == 0 ? amount : 0;
+    }
+}
+
+void Processor::ReplayBoundaryInputs() {
+    axxd& rates = *m_solver->GetChangeRates();
+    int passSize = GetBoundaryPassSize();
+    if ((m_boundaryPass + 1) * passSize > m_boundaryStepSize) {
+        throw ShouldNotHappen();
+    }
+
+    const double* values = &m_boundaryRecord[m_boundaryStep * m_boundaryStepSize + m_boundaryPass * passSize];
+    m_boundaryPass++;
+
+    for (const auto& input : m_boundaryInputs) {
+        input.container->SetStaticContentChange(*values++);
+        SetSummedAmount(input.fluxes, *values++);
+        for (int col = 0; col < rates.cols(); ++col) {
+            for (int i = 0; i < input.rows.size(); ++i) {
+                rates(input.rows[i], col) = i == 0 ? *values : 0;
+            }
+            values++;
+        }
+    }
+    SetSummedAmount(m_boundaryOutletFluxes, *values);
+}
+
+void Processor::StoreBoundaryStep() {
+    int stepsNb = m_model->GetTimeMachine()->GetTimeStepsNb();
+    if (m_boundaryStepSize == 0) {
+        m_boundaryStepSize = int(m_boundaryStepValues.size());
+        m_boundaryRecord.assign(size_t(stepsNb) * m_boundaryStepSize, NAN_D);
+        m_boundaryStepsRecorded.assign(stepsNb, 0);
+    }
+    if (m_boundaryStepValues.size() != m_boundaryStepSize || m_boundaryStep >= stepsNb) {
+        throw ShouldNotHappen();
+    }
+
+    std::copy(m_boundaryStepValues.begin(), m_boundaryStepValues.end(),
+              m_boundaryRecord.begin() + size_t(m_boundaryStep) * m_boundaryStepSize);
+    m_boundaryStepsRecorded[m_boundaryStep] = 1;
+}
+
+void Processor::BuildActivityInputs() {
+    m_activityInputs.clear();
+    m_activityInputsStart.clear();
+
+    // Bricks originating the outgoing fluxes
+    std::unordered_map<Flux*, int> fluxSources;
+    for (int iBrick = 0; iBrick < m_iterableBricks.size(); ++iBrick) {
+        for (auto process : m_iterableBricks[iBrick]->GetProcesses()) {
+            for (auto flux : process->GetOutputFluxes()) {
+                fluxSources[flux] = iBrick;
+            }
+        }
+    }
+
+    for (auto brick : m_iterableBricks) {
+        m_activityInputsStart.push_back(int(m_activityInputs.size()));
+        for (auto container : brick->GetWaterContainers()) {
+            for (auto flux : container->GetInputFluxes()) {
+                ActivityInput input;
+                input.flux = flux;
+                auto source = fluxSources.find(flux);
+                if (source != fluxSources.end()) {
+                    input.sourceBrick = source->second;
+                }
+                m_activityInputs.push_back(input);
+            }
+        }
+    }
+    m_activityInputsStart.push_back(int(m_activityInputs.size()));
+}
+
+bool Processor::IsDirectBrickQuiescent(Brick* brick) {
+    if (!brick->HasNoContentNorOutgoingFlux()) {
+        return false;
+    }
+    for (auto container : brick->GetWaterContainers()) {
+        for (auto flux : container->GetInputFluxes()) {
+            if (flux->GetAmount() != 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int Processor::UpdateBricksActivity(int bricksStart, int bricksEnd, int upToDateStart) {
+    // Bricks that are empty and have no input from outside the solver
+    for (int iBrick = bricksStart; iBrick < bricksEnd; ++iBrick) {
+        Brick* brick = m_iterableBricks[iBrick];
+        bool quiescent = brick->HasNoContentNorOutgoingFlux();
+        for (int i = m_activityInputsStart[iBrick]; quiescent && i < m_activityInputsStart[iBrick + 1]; ++i) {
+            const ActivityInput& input = m_activityInputs[i];
+            if (input.sourceBrick < 0 && input.flux->GetAmount() != 0) {
+                quiescent = false;
+            }
+        }
+        brick->SetQuiescent(quiescent);
+    }
+
+    // Propagate the activity of the upstream bricks. The bricks outside [upToDateStart, bricksEnd[ are not
+    // updated yet (or processed concurrently) and are considered as active.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int iBrick = bricksStart; iBrick < bricksEnd; ++iBrick) {
+            Brick* brick = m_iterableBricks[iBrick];
+            if (!brick->IsQuiescent()) {
                 continue;
             }
+            for (int i = m_activityInputsStart[iBrick]; i < m_activityInputsStart[iBrick + 1]; ++i) {
+                int source = m_activityInputs[i].sourceBrick;
+                if (source < 0) {
+                    continue;
+                }
+                if (source < upToDateStart || source >= bricksEnd || !m_iterableBricks[source]->IsQuiescent()) {
+                    brick->SetQuiescent(false);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
 
-            ApplyDirectChanges(brick, ptIndex);
+    int quiescentNb = 0;
+    for (int iBrick = bricksStart; iBrick < bricksEnd; ++iBrick) {
+        if (m_iterableBricks[iBrick]->IsQuiescent()) {
+            quiescentNb++;
         }
     }
 
+    return quiescentNb;
+}
+
+double Processor::GetSkippedBricksFraction() const {
+    if (m_bricksNb == 0) {
+        return 0;
+    }
+    return double(m_skippedBricksNb) / double(m_bricksNb);
+}
+
+double Processor::GetSkippedUnitsFraction() const {
+    if (m_unitsNb == 0) {
+        return 0;
+    }
+    return double(m_skippedUnitsNb) / double(m_unitsNb);
+}
+
+void Processor::ResetQuiescenceCounters() {
+    m_bricksNb = 0;
+    m_skippedBricksNb = 0;
+    m_unitsNb = 0;
+    m_skippedUnitsNb = 0;
+}
+
+void Processor::ResetSolver() {
+    if (m_solver) {
+        m_solver->Reset();
+    }
+}
+
+void Processor::StoreStateVariables(Brick* brick) {
+    for (auto container : brick->GetWaterContainers()) {
+        m_stateContainers.push_back(container);
+    }
+}
+
+int Processor::GetNbStateVariables() {
+    return int(m_stateContainers.size());
+}
+
+void Processor::ForEachBlock(const std::function<void(const ProcessingBlock&)>& task) {
+    if (m_boundaryMode == BoundaryReplay) {
+        // The hydro units are not processed; their contribution to the sub basin is taken from the record.
+        ReplayBoundaryInputs();
+        task(m_subBasinBlock);
+        return;
+    }
+
+    if (m_threadPool) {
+        m_threadPool->ParallelFor(int(m_unitBlocks.size()), [&](int iBlock) { task(m_unitBlocks[iBlock]); });
+    } else {
+        for (const auto& block : m_unitBlocks) {
+            task(block);
+        }
+    }
+
+    // Instantaneous fluxes from the hydro units to the sub basin bricks are transferred serially.
+    TransferDeferredFluxes();
+
+    if (m_boundaryMode == BoundaryRecord) {
+        RecordBoundaryInputs();
+    }
+
+    // The sub basin bricks gather the outputs of all hydro units and are thus processed last.
+    task(m_subBasinBlock);
+}
+
+bool Processor::ProcessTimeStep() {
+    wxASSERT(m_model);
+
+    if (m_boundaryMode != BoundaryOff) {
+        m_boundaryStep = m_model->GetTimeMachine()->GetTimeStepIndex();
+        m_boundaryPass = 0;
+        m_boundaryStepValues.clear();
+        if (m_boundaryMode == BoundaryReplay && !HasBoundaryRecordFrom(m_boundaryStep)) {
+            wxLogError(_("The inputs of the sub basin were not recorded for the time step %d."), m_boundaryStep);
+            return false;
+        }
+    }
+
+    // Process the bricks that do not need a solver.
+    ForEachBlock([this](const ProcessingBlock& block) { ProcessDirectChanges(block); });
+
     // Process the bricks that need a solver
     if (!m_solver->Solve()) {
         return false;
     }
 
-    if (!basin->ComputeOutletDischarge()) {
+    if (!m_model->GetSubBasin()->ComputeOutletDischarge()) {
         return false;
     }
 
+    if (m_boundaryMode == BoundaryRecord) {
+        StoreBoundaryStep();
+    }
+
     return true;
 }
 
+void Processor::ProcessDirectChanges(const ProcessingBlock& block) {
+    SubBasin* basin = m_model->GetSubBasin();
+
+    long long bricksNb = 0;
+    long long skippedBricksNb = 0;
+    long long skippedUnitsNb = 0;
+
+    int ptIndex = block.directRatesStart;
+    for (int iUnit = block.unitsStart; iUnit < block.unitsEnd; ++iUnit) {
+        HydroUnit* unit = basin->GetHydroUnit(iUnit);
+        for (int iSplitter = 0; iSplitter < unit->GetSplittersCount(); ++iSplitter) {
+            Splitter* splitter = unit->GetSplitter(iSplitter);
+            splitter->Compute();
+        }
+        int unitBricksNb = 0;
+        int unitSkippedBricksNb = 0;
+        for (int iBrick = m_directBricksStart[iUnit]; iBrick < m_directBricksStart[iUnit + 1]; ++iBrick) {
+            Brick* brick = m_directBricks[iBrick];
+            wxASSERT(!brick->IsNull());
+
+            unitBricksNb++;
+            if (m_skipQuiescentBricks && IsDirectBrickQuiescent(brick)) {
+                // The rates of the brick keep their slots, to which its outgoing fluxes are still linked.
+                ptIndex += brick->GetProcessesConnectionsNb();
+                unitSkippedBricksNb++;
+                continue;
+            }
+
+            ApplyDirectChanges(brick, ptIndex);
+        }
+
+        // Flag the quiescent bricks to skip in the solver
+        if (m_skipQuiescentBricks) {
+            const ProcessingBlock& range = m_unitRanges[iUnit];
+            unitBricksNb += range.bricksEnd - range.bricksStart;
+            unitSkippedBricksNb += UpdateBricksActivity(range.bricksStart, range.bricksEnd, range.bricksStart);
+        }
+
+        bricksNb += unitBricksNb;
+        skippedBricksNb += unitSkippedBricksNb;
+        if (unitBricksNb > 0 && unitSkippedBricksNb == unitBricksNb) {
+            skippedUnitsNb++;
+        }
+    }
+
+    // The sub basin bricks can depend on all the hydro units, which are already processed (unless replayed, in
+    // which case the bricks of the hydro units are considered as active).
+    if (m_skipQuiescentBricks && block.isSubBasin) {
+        int upToDateStart = m_boundaryMode == BoundaryReplay ? block.bricksStart : 0;
+        bricksNb += block.bricksEnd - block.bricksStart;
+        skippedBricksNb += UpdateBricksActivity(block.bricksStart, block.bricksEnd, upToDateStart);
+    }
+
+    m_bricksNb += bricksNb;
+    m_skippedBricksNb += skippedBricksNb;
+    m_unitsNb += block.unitsEnd - block.unitsStart;
+    m_skippedUnitsNb += skippedUnitsNb;
+}
 void Processor::ApplyDirectChanges(Brick* brick, int& ptIndex) {
     brick->UpdateContentFromInputs();
 
@@ -144,21 +806,16 @@ void Processor::ApplyDirectChanges(Brick* brick, int& ptIndex) {
     iRate = ptIndex;
     for (auto process : brick->GetProcesses()) {
         // Get the change rates (per day) independently of the time step and constraints
-        vecDouble rates = process->GetChangeRates();
-
-        int iRateCopy = iRate;
-        for (double rate : rates) {
-            wxASSERT(m_changeRatesNoSolver.rows() > iRateCopy);
-            m_changeRatesNoSolver(iRateCopy) = rate;
-            iRateCopy++;
-        }
+        int connectionsNb = process->GetConnectionsNb();
+        wxASSERT(m_changeRatesNoSolver.rows() >= iRate + connectionsNb);
+        process->GetChangeRates(&m_changeRatesNoSolver(iRate));
 
         // Apply constraints for the current brick (e.g. maximum capacity or avoid negative values)
-        process->GetWaterContainer()->ApplyConstraints(g_timeStepInDays);
+        process->GetWaterContainer()->ApplyConstraints(m_timeStepInDays);
 
         // Apply changes
-        for (int i = 0; i < rates.size(); ++i) {
-            process->ApplyChange(i, m_changeRatesNoSolver(iRate), g_timeStepInDays);
+        for (int i = 0; i < connectionsNb; ++i) {
+            process->ApplyChange(i, m_changeRatesNoSolver(iRate), m_timeStepInDays);
             m_changeRatesNoSolver(iRate) = 0;
             iRate++;
             ptIndex++;
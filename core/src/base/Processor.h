@@ -1,12 +1,53 @@
 #ifndef HYDROBRICKS_PROCESSOR_H
 #define HYDROBRICKS_PROCESSOR_H
 
+#include <atomic>
+#include <functional>
+
 #include "Brick.h"
+#include "ContainerConstraint.h"
+#include "FluxToBrickInstantaneous.h"
 #include "Includes.h"
 #include "Solver.h"
+#include "ThreadPool.h"
 
 class ModelHydro;
 
+/**
+ * Contiguous range of hydro units and of the related elements in the processor containers. The hydro units of
+ * different blocks do not interact and can be processed concurrently.
+ */
+struct ProcessingBlock {
+    int unitsStart = 0;
+    int unitsEnd = 0;
+    int bricksStart = 0;
+    int bricksEnd = 0;
+    int ratesStart = 0;
+    int stateVariablesStart = 0;
+    int stateVariablesEnd = 0;
+    int directRatesStart = 0;
+    bool isSubBasin = false;
+};
+
+/**
+ * Incoming flux of a brick to solve, used to track the activity of the brick. The source is the index of the
+ * originating brick in the iterable bricks, or -1 if it is not solved (e.g., forcing or brick without solver).
+ */
+struct ActivityInput {
+    Flux* flux = nullptr;
+    int sourceBrick = -1;
+};
+
+/**
+ * Inputs of a sub basin container coming from the hydro units: the incoming fluxes and the rows of their change
+ * rates in the solver.
+ */
+struct BoundaryInput {
+    WaterContainer* container = nullptr;
+    vector<Flux*> fluxes;
+    vecInt rows;
+};
+
 class Processor : public wxObject {
   public:
     explicit Processor();
@@ -19,14 +60,52 @@ class Processor : public wxObject {
 
     void ConnectToElementsToSolve();
 
+    /**
+     * Rebuild the processing structures if the area of some bricks became null or not null (e.g., after a land
+     * cover change). The bricks with a null area are excluded from the processing.
+     */
+    void UpdateActiveBricks();
+
     int GetNbStateVariables();
 
     bool ProcessTimeStep();
 
-    vecDoublePt* GetStateVariablesVectorPt() {
+    /**
+     * Run the task on all the blocks: first on the hydro units blocks (concurrently if multiple threads are
+     * used), then on the sub basin block.
+     *
+     * @param task The task to run on each block.
+     */
+    void ForEachBlock(const std::function<void(const ProcessingBlock&)>& task);
+
+    axd* GetStateVariableChanges() {
         return &m_stateVariableChanges;
     }
 
+    vector<WaterContainer*>* GetStateContainersVectorPt() {
+        return &m_stateContainers;
+    }
+
+    vector<RateKernel>* GetRateKernelsVectorPt() {
+        return &m_rateKernels;
+    }
+
+    /**
+     * Build the rate kernels of the processes to solve (one per connection). Must be called again when the
+     * parameters are updated.
+     */
+    void BuildRateKernels();
+
+    ConstraintTable* GetConstraintTable() {
+        return &m_constraintTable;
+    }
+
+    /**
+     * Resolve the outgoing and incoming change rates of the containers to solve into rows of the solver change
+     * rates vector. Must be called after the connection to the elements to solve.
+     */
+    void BuildConstraintTable();
+
     vector<Brick*>* GetIterableBricksVectorPt() {
         return &m_iterableBricks;
     }
@@ -39,19 +118,156 @@ class Processor : public wxObject {
         return m_directConnectionsNb;
     }
 
+    int GetThreadsNb() const {
+        return m_threadsNb;
+    }
+
+    Solver* GetSolver() {
+        return m_solver;
+    }
+
+    /**
+     * Set the time step of the model. It is carried by the processor (and not by a global variable) so that
+     * several models can run concurrently in the same process.
+     *
+     * @param timeStepInDays The time step [d].
+     */
+    void SetTimeStepInDays(double timeStepInDays) {
+        wxASSERT(timeStepInDays > 0);
+        m_timeStepInDays = timeStepInDays;
+    }
+
+    double GetTimeStepInDays() const {
+        return m_timeStepInDays;
+    }
+
+    /**
+     * Get the fraction of the bricks processing that was skipped as the bricks were quiescent.
+     *
+     * @return The fraction of skipped bricks over all the processed time steps.
+     */
+    double GetSkippedBricksFraction() const;
+
+    /**
+     * Get the fraction of the hydro units processing that was skipped as all their bricks were quiescent.
+     *
+     * @return The fraction of skipped hydro units over all the processed time steps.
+     */
+    double GetSkippedUnitsFraction() const;
+
+    void ResetQuiescenceCounters();
+
+    /**
+     * Reset the values carried by the solver from one time step to the next.
+     */
+    void ResetSolver();
+
+    /**
+     * Check that the inputs of the sub basin coming from the hydro units can be replayed: the solver must process
+     * the same sequence of operations at every time step and the sub basin bricks must not limit their inputs
+     * (which would act on the hydro units).
+     *
+     * @return True if the inputs can be replayed.
+     */
+    bool SupportsBoundaryReplay();
+
+    /**
+     * Set how the inputs of the sub basin coming from the hydro units are handled. When recording, they are stored
+     * at every pass of the solver on the sub basin block. When replaying, the hydro units are not processed and the
+     * stored inputs are used instead.
+     *
+     * @param mode The boundary mode.
+     */
+    void SetBoundaryMode(BoundaryMode mode) {
+        m_boundaryMode = mode;
+    }
+
+    BoundaryMode GetBoundaryMode() const {
+        return m_boundaryMode;
+    }
+
+    /**
+     * Check if the inputs of the sub basin are recorded for all the time steps starting from the given one.
+     *
+     * @param timeStep The index of the first time step.
+     * @return True if the record is complete.
+     */
+    bool HasBoundaryRecordFrom(int timeStep) const;
+
+    void ClearBoundaryRecord();
+
   protected:
     Solver* m_solver;
     ModelHydro* m_model;
+    ThreadPool* m_threadPool;
+    int m_threadsNb;
+    double m_timeStepInDays;
+    bool m_inlineRateKernels;
+    bool m_skipQuiescentBricks;
+    bool m_analyticalLinearStorages;
     int m_solvableConnectionsNb;
     int m_directConnectionsNb;
-    vecDoublePt m_stateVariableChanges;
+    vector<WaterContainer*> m_stateContainers;
+    axd m_stateVariableChanges;
     vector<Brick*> m_iterableBricks;
+    vector<Brick*> m_directBricks;
+    vecInt m_directBricksStart;
+    vector<Brick*> m_nullBricks;
+    vector<RateKernel> m_rateKernels;
+    ConstraintTable m_constraintTable;
+    vector<ProcessingBlock> m_unitRanges;
+    vector<ProcessingBlock> m_unitBlocks;
+    ProcessingBlock m_subBasinBlock;
+    vector<FluxToBrickInstantaneous*> m_deferredFluxes;
     axd m_changeRatesNoSolver;
+    vector<ActivityInput> m_activityInputs;
+    vecInt m_activityInputsStart;
+    std::atomic<long long> m_bricksNb;
+    std::atomic<long long> m_skippedBricksNb;
+    std::atomic<long long> m_unitsNb;
+    std::atomic<long long> m_skippedUnitsNb;
+    BoundaryMode m_boundaryMode;
+    vector<BoundaryInput> m_boundaryInputs;
+    vector<Flux*> m_boundaryOutletFluxes;
+    vecDouble m_boundaryRecord;
+    vecDouble m_boundaryStepValues;
+    vector<char> m_boundaryStepsRecorded;
+    int m_boundaryStepSize;
+    int m_boundaryStep;
+    int m_boundaryPass;
 
   private:
-    void StoreStateVariableChanges(vecDoublePt& values);
+    void StoreStateVariables(Brick* brick);
+
+    void CreateUnitBlocks(const vector<ProcessingBlock>& unitRanges);
+
+    void BuildProcessingTables();
+
+    vector<Brick*> CollectNullBricks();
+
+    void DeferInstantaneousFluxesToSubBasin();
+
+    void TransferDeferredFluxes();
+
+    void ProcessDirectChanges(const ProcessingBlock& block);
 
     void ApplyDirectChanges(Brick* brick, int& ptIndex);
+
+    void BuildActivityInputs();
+
+    bool IsDirectBrickQuiescent(Brick* brick);
+
+    int UpdateBricksActivity(int bricksStart, int bricksEnd, int upToDateStart);
+
+    void BuildBoundaryInputs();
+
+    int GetBoundaryPassSize() const;
+
+    void RecordBoundaryInputs();
+
+    void ReplayBoundaryInputs();
+
+    void StoreBoundaryStep();
 };
 
 #endif  // HYDROBRICKS_PROCESSOR_H
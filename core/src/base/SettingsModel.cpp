@@ -15,17 +15,94 @@ SettingsModel::SettingsModel()
     m_selectedStructure = &m_modelStructures[0];
 }
 
+SettingsModel::SettingsModel(const SettingsModel& other)
+    : wxObject(),
+      m_logAll(other.m_logAll),
+      m_modelStructures(other.m_modelStructures),
+      m_solver(other.m_solver),
+      m_timer(other.m_timer),
+      m_selectedStructure(nullptr),
+      m_selectedBrick(nullptr),
+      m_selectedProcess(nullptr),
+      m_selectedSplitter(nullptr) {
+    for (auto& modelStructure : m_modelStructures) {
+        for (auto& brick : modelStructure.hydroUnitBricks) {
+            DuplicateParameters(brick.parameters);
+            for (auto& process : brick.processes) {
+                DuplicateParameters(process.parameters);
+            }
+        }
+        for (auto& brick : modelStructure.subBasinBricks) {
+            DuplicateParameters(brick.parameters);
+            for (auto& process : brick.processes) {
+                DuplicateParameters(process.parameters);
+            }
+        }
+        for (auto& splitter : modelStructure.hydroUnitSplitters) {
+            DuplicateParameters(splitter.parameters);
+        }
+        for (auto& splitter : modelStructure.subBasinSplitters) {
+            DuplicateParameters(splitter.parameters);
+        }
+    }
+
+    // Point to the same selected elements as the original settings
+    if (other.m_selectedStructure == nullptr) {
+        return;
+    }
+    const ModelStructure& otherStructure = *other.m_selectedStructure;
+    m_selectedStructure = &m_modelStructures[other.m_selectedStructure - other.m_modelStructures.data()];
+
+    for (int i = 0; i < otherStructure.hydroUnitBricks.size(); ++i) {
+        if (other.m_selectedBrick == &otherStructure.hydroUnitBricks[i]) {
+            m_selectedBrick = &m_selectedStructure->hydroUnitBricks[i];
+        }
+    }
+    for (int i = 0; i < otherStructure.subBasinBricks.size(); ++i) {
+        if (other.m_selectedBrick == &otherStructure.subBasinBricks[i]) {
+            m_selectedBrick = &m_selectedStructure->subBasinBricks[i];
+        }
+    }
+    if (m_selectedBrick != nullptr) {
+        for (int i = 0; i < other.m_selectedBrick->processes.size(); ++i) {
+            if (other.m_selectedProcess == &other.m_selectedBrick->processes[i]) {
+                m_selectedProcess = &m_selectedBrick->processes[i];
+            }
+        }
+    }
+    for (int i = 0; i < otherStructure.hydroUnitSplitters.size(); ++i) {
+        if (other.m_selectedSplitter == &otherStructure.hydroUnitSplitters[i]) {
+            m_selectedSplitter = &m_selectedStructure->hydroUnitSplitters[i];
+        }
+    }
+    for (int i = 0; i < otherStructure.subBasinSplitters.size(); ++i) {
+        if (other.m_selectedSplitter == &otherStructure.subBasinSplitters[i]) {
+            m_selectedSplitter = &m_selectedStructure->subBasinSplitters[i];
+        }
+    }
+}
+
 SettingsModel::~SettingsModel() {
     for (auto& modelStructure : m_modelStructures) {
         for (auto& brick : modelStructure.hydroUnitBricks) {
             for (auto& parameter : brick.parameters) {
                 wxDELETE(parameter);
             }
+            for (auto& process : brick.processes) {
+                for (auto& parameter : process.parameters) {
+                    wxDELETE(parameter);
+                }
+            }
         }
         for (auto& brick : modelStructure.subBasinBricks) {
             for (auto& parameter : brick.parameters) {
                 wxDELETE(parameter);
             }
+            for (auto& process : brick.processes) {
+                for (auto& parameter : process.parameters) {
+                    wxDELETE(parameter);
+                }
+            }
         }
         for (auto& splitter : modelStructure.hydroUnitSplitters) {
             for (auto& parameter : splitter.parameters) {
@@ -40,10 +117,44 @@ SettingsModel::~SettingsModel() {
     }
 }
 
+void SettingsModel::DuplicateParameters(vector<Parameter*>& parameters) {
+    for (auto& parameter : parameters) {
+        parameter = new Parameter(parameter->GetName(), parameter->GetValue());
+    }
+}
+
 void SettingsModel::SetSolver(const string& solverName) {
     m_solver.name = solverName;
 }
 
+void SettingsModel::SetThreadsNb(int threadsNb) {
+    if (threadsNb < 1) {
+        throw InvalidArgument(wxString::Format(_("The number of threads must be positive (%d given)."), threadsNb));
+    }
+    m_solver.threadsNb = threadsNb;
+}
+
+void SettingsModel::SetSolverTolerances(double absoluteTolerance, double relativeTolerance) {
+    if (absoluteTolerance <= 0 || relativeTolerance < 0) {
+        throw InvalidArgument(wxString::Format(_("Incorrect solver tolerances (absolute: %g, relative: %g)."),
+                                               absoluteTolerance, relativeTolerance));
+    }
+    m_solver.absoluteTolerance = absoluteTolerance;
+    m_solver.relativeTolerance = relativeTolerance;
+}
+
+void SettingsModel::SetAnalyticalLinearStorages(bool active) {
+    m_solver.analyticalLinearStorages = active;
+}
+
+void SettingsModel::SetInlineRateKernels(bool active) {
+    m_solver.inlineRateKernels = active;
+}
+
+void SettingsModel::SetSkipQuiescentBricks(bool active) {
+    m_solver.skipQuiescentBricks = active;
+}
+
 void SettingsModel::SetTimer(const string& start, const string& end, int timeStep, const string& timeStepUnit) {
     m_timer.start = start;
     m_timer.end = end;
@@ -262,6 +373,19 @@ void SettingsModel::SetProcessOutputsAsStatic() {
     }
 }
 
+void SettingsModel::SetProcessOutputsLag(const string& kernel, const vecDouble& parameters) {
+    wxASSERT(m_selectedProcess);
+
+    for (auto& output : m_selectedProcess->outputs) {
+        if (output.target != "outlet") {
+            throw InvalidArgument(wxString::Format(_("Only the outputs to the outlet can be lagged (not to '%s')."),
+                                                   output.target));
+        }
+        output.lagKernel = kernel;
+        output.lagParameters = parameters;
+    }
+}
+
 void SettingsModel::OutputProcessToSameBrick() {
     wxASSERT(m_selectedBrick);
     wxASSERT(m_selectedProcess);
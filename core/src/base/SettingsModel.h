@@ -8,6 +8,12 @@
 
 struct SolverSettings {
     string name;
+    int threadsNb = 1;
+    double absoluteTolerance = 0.001;
+    double relativeTolerance = 0.001;
+    bool analyticalLinearStorages = false;
+    bool inlineRateKernels = true;
+    bool skipQuiescentBricks = true;
 };
 
 struct TimerSettings {
@@ -22,6 +28,8 @@ struct OutputSettings {
     string fluxType = "water";
     bool isInstantaneous = false;
     bool isStatic = false;
+    string lagKernel;
+    vecDouble lagParameters;
 };
 
 struct ProcessSettings {
@@ -67,10 +75,29 @@ class SettingsModel : public wxObject {
   public:
     explicit SettingsModel();
 
+    /**
+     * Copy the settings. The parameters are duplicated so that both settings can hold different values.
+     *
+     * @param other The settings to copy.
+     */
+    SettingsModel(const SettingsModel& other);
+
+    SettingsModel& operator=(const SettingsModel&) = delete;
+
     ~SettingsModel() override;
 
     void SetSolver(const string& solverName);
 
+    void SetThreadsNb(int threadsNb);
+
+    void SetSolverTolerances(double absoluteTolerance, double relativeTolerance);
+
+    void SetAnalyticalLinearStorages(bool active = true);
+
+    void SetInlineRateKernels(bool active = true);
+
+    void SetSkipQuiescentBricks(bool active = true);
+
     void SetTimer(const string& start, const string& end, int timeStep, const string& timeStepUnit);
 
     void AddHydroUnitBrick(const string& name, const std::string& type = "storage");
@@ -105,6 +132,14 @@ class SettingsModel : public wxObject {
 
     void SetProcessOutputsAsStatic();
 
+    /**
+     * Lag the outputs of the selected process by a unit hydrograph. Only the outputs to the outlet can be lagged.
+     *
+     * @param kernel The kernel type: "triangular", "gamma" or "nash_cascade".
+     * @param parameters The kernel parameters, expressed in time steps (see ModifierLag::Create()).
+     */
+    void SetProcessOutputsLag(const string& kernel, const vecDouble& parameters);
+
     void OutputProcessToSameBrick();
 
     void AddHydroUnitSplitter(const string& name, const string& type);
@@ -303,6 +338,8 @@ class SettingsModel : public wxObject {
     ProcessSettings* m_selectedProcess;
     SplitterSettings* m_selectedSplitter;
 
+    static void DuplicateParameters(vector<Parameter*>& parameters);
+
     vecStr ParseLandCoverNames(const YAML::Node& settings);
 
     vecStr ParseLandCoverTypes(const YAML::Node& settings);
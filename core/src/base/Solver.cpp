@@ -1,21 +1,187 @@
 #include "Solver.h"
 
+#include "IceContainer.h"
 #include "Processor.h"
+#include "ProcessETSocont.h"
+#include "ProcessInfiltrationSocont.h"
+#include "ProcessOutflowLinear.h"
+#include "ProcessRunoffSocont.h"
+#include "SolverBogackiShampine.h"
 #include "SolverEulerExplicit.h"
+#include "SolverEulerImplicit.h"
 #include "SolverHeunExplicit.h"
 #include "SolverRK4.h"
 
+/**
+ * Compute the change rates of a process from its kernel. The common processes are evaluated inline and give the same
+ * results as Process::GetChangeRates(); the others are delegated to the process.
+ */
+static inline void ComputeKernelRates(const RateKernel& kernel, double* rates) {
+    if (kernel.type == RateKernelType::Generic) {
+        kernel.process->GetChangeRates(rates);
+        return;
+    }
+
+    double content = kernel.container->GetContentWithChanges();
+    if (content <= PRECISION) {
+        rates[0] = 0;
+        return;
+    }
+
+    switch (kernel.type) {
+        case RateKernelType::Zero:
+            rates[0] = 0;
+            break;
+        case RateKernelType::OutflowLinear:
+            rates[0] = ProcessOutflowLinear::ComputeRate(content, *kernel.parameter);
+            break;
+        case RateKernelType::OutflowPercolation:
+            rates[0] = *kernel.parameter;
+            break;
+        case RateKernelType::OutflowDirect:
+            rates[0] = content;
+            break;
+        case RateKernelType::InfiltrationSocont:
+            if (kernel.target->GetMaximumCapacity() <= 0) {
+                rates[0] = 0;
+                break;
+            }
+            rates[0] = ProcessInfiltrationSocont::ComputeRate(content, kernel.target->GetTargetFillingRatio());
+            break;
+        case RateKernelType::ETSocont:
+            rates[0] = ProcessETSocont::ComputeRate(kernel.forcing->GetValue(),
+                                                    kernel.container->GetTargetFillingRatio(), kernel.exponent);
+            break;
+        case RateKernelType::RunoffSocont: {
+            double area = kernel.areaFraction ? kernel.area * *kernel.areaFraction : kernel.area;
+            rates[0] = ProcessRunoffSocont::ComputeRate(content, *kernel.parameter, kernel.slope, area,
+                                                        kernel.exponent);
+            break;
+        }
+        default:
+            kernel.process->GetChangeRates(rates);
+    }
+}
+
+/**
+ * Null the overflow rates of a brick, as the overflow is only defined by the constraints.
+ */
+static inline void NullOverflowRates(const ConstraintTable& table, int iBrick, double* rates) {
+    for (int i = table.bricksStart[iBrick]; i < table.bricksStart[iBrick + 1]; ++i) {
+        if (table.constraints[i].overflowRow >= 0) {
+            rates[table.constraints[i].overflowRow] = 0;
+        }
+    }
+}
+
+/**
+ * Enforce the constraints of a container (avoid negative content and enforce the maximum capacity) on the change
+ * rates vector. It gives the same results as WaterContainer::ApplyConstraints() without relying on the fluxes.
+ */
+static inline void ApplyContainerConstraint(const ConstraintTable& table, const ContainerConstraint& constraint,
+                                            double* rates, double timeStep) {
+    const int* rows = table.rows.data();
+
+    if (constraint.ice && constraint.ice->IsMeltBlocked()) {
+        for (int i = constraint.outputsStart; i < constraint.outputsEnd; ++i) {
+            rates[rows[i]] = 0;
+        }
+    }
+
+    // Get outgoing change rates
+    double outputs = 0;
+    for (int i = constraint.outputsStart; i < constraint.outputsEnd; ++i) {
+        double& rate = rates[rows[i]];
+        wxASSERT(rate < 1000);
+        if (rate < 0) {
+            rate = 0;
+        }
+        outputs += rate;
+    }
+
+    // Get incoming change rates
+    double inputs = 0;
+    double inputsStatic = 0;
+    for (int i = constraint.staticInputsStart; i < constraint.staticInputsEnd; ++i) {
+        const ConstraintStaticInput& input = table.staticInputs[i];
+        inputsStatic += input.forcing ? input.forcing->GetValue() : *input.amount;
+    }
+    for (int i = constraint.inputsStart; i < constraint.inputsEnd; ++i) {
+        double& rate = rates[rows[i]];
+        wxASSERT(rate < 1000);
+        if (rate < 0) {
+            rate = 0;
+        }
+        inputs += rate;
+    }
+
+    double change = inputs - outputs;
+    double content = constraint.container->GetContentWithDynamicChanges();
+
+    // Avoid negative content
+    if (change < 0 && content + inputsStatic + change * timeStep < 0) {
+        double diff = (content + inputsStatic + change * timeStep) / timeStep;
+        // Limit the different rates proportionally
+        for (int i = constraint.outputsStart; i < constraint.outputsEnd; ++i) {
+            double& rate = rates[rows[i]];
+            wxASSERT(rate < 1000);
+            wxASSERT(rate >= 0);
+            if (rate <= EPSILON_D) {
+                continue;
+            }
+            if (std::abs(diff - change) < PRECISION) {
+                rate = 0;
+                continue;
+            }
+            rate += diff * std::abs(rate / outputs);
+        }
+    }
+
+    // Enforce maximum capacity
+    if (constraint.capacity == nullptr) {
+        return;
+    }
+    double capacity = *constraint.capacity;
+    if (content + inputsStatic + change * timeStep > capacity) {
+        double diff = (content + inputsStatic + change * timeStep - capacity) / timeStep;
+        // If it has an overflow, use it
+        if (constraint.overflowRow >= 0) {
+            rates[constraint.overflowRow] = diff;
+            return;
+        }
+        // Check that it is not only due to forcing
+        if (content + inputsStatic > capacity) {
+            throw ConceptionIssue(_("Forcing is coming directly into a brick with limited capacity and no overflow."));
+        }
+        // Limit the different rates proportionally
+        for (int i = constraint.inputsStart; i < constraint.inputsEnd; ++i) {
+            double& rate = rates[rows[i]];
+            wxASSERT(rate < 1000);
+            wxASSERT(rate > -EPSILON_D);
+            if (rate == 0.0) {
+                continue;
+            }
+            rate -= diff * std::abs(rate / inputs);
+        }
+    }
+}
+
 Solver::Solver()
     : m_processor(nullptr),
-      m_nIterations(1) {}
+      m_nIterations(1),
+      m_timeStepInDays(1) {}
 
 Solver* Solver::Factory(const SolverSettings& solverSettings) {
     if (solverSettings.name == "rk4" || solverSettings.name == "runge_kutta") {
         return new SolverRK4();
     } else if (solverSettings.name == "euler_explicit") {
         return new SolverEulerExplicit();
+    } else if (solverSettings.name == "euler_implicit" || solverSettings.name == "backward_euler") {
+        return new SolverEulerImplicit();
     } else if (solverSettings.name == "heun_explicit") {
         return new SolverHeunExplicit();
+    } else if (solverSettings.name == "bogacki_shampine" || solverSettings.name == "rk23_adaptive") {
+        return new SolverBogackiShampine(solverSettings.absoluteTolerance, solverSettings.relativeTolerance);
     }
     throw InvalidArgument(wxString::Format(_("Incorrect solver name: %s."), solverSettings.name));
 }
@@ -23,128 +189,273 @@ Solver* Solver::Factory(const SolverSettings& solverSettings) {
 void Solver::InitializeContainers() {
     wxASSERT(m_processor);
     wxASSERT(m_nIterations > 0);
+    m_timeStepInDays = m_processor->GetTimeStepInDays();
     m_stateVariableChanges = axxd::Zero(m_processor->GetNbStateVariables(), m_nIterations);
     m_changeRates = axxd::Zero(m_processor->GetNbSolvableConnections(), m_nIterations);
+    m_subStepRates = axd::Zero(m_processor->GetNbSolvableConnections());
+    m_subStepAmounts = axd::Zero(m_processor->GetNbSolvableConnections());
 }
 
 void Solver::SaveStateVariables(int col) {
     wxASSERT(m_processor);
-    int counter = 0;
-    for (auto value : *(m_processor->GetStateVariablesVectorPt())) {
-        m_stateVariableChanges(counter, col) = *value;
-        counter++;
-    }
+    m_processor->ForEachBlock([this, col](const ProcessingBlock& block) { SaveStateVariables(block, col); });
+}
+
+void Solver::SaveStateVariables(const ProcessingBlock& block, int col) {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    int start = block.stateVariablesStart;
+    int size = block.stateVariablesEnd - start;
+    m_stateVariableChanges.col(col).segment(start, size) = values.segment(start, size);
 }
 
 void Solver::ComputeChangeRates(int col, bool applyConstraints) {
     wxASSERT(m_processor);
-    int iRate = 0;
-    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
+    m_processor->ForEachBlock([this, col, applyConstraints](const ProcessingBlock& block) {
+        ComputeChangeRates(block, col, applyConstraints);
+    });
+}
+
+void Solver::ComputeChangeRates(const ProcessingBlock& block, int col, bool applyConstraints) {
+    vector<Brick*>& bricks = *(m_processor->GetIterableBricksVectorPt());
+    vector<RateKernel>& kernels = *(m_processor->GetRateKernelsVectorPt());
+    const ConstraintTable& table = *(m_processor->GetConstraintTable());
+    double* rates = m_changeRates.col(col).data();
+    int iRate = block.ratesStart;
+    for (int iBrick = block.bricksStart; iBrick < block.bricksEnd; ++iBrick) {
+        Brick* brick = bricks[iBrick];
+        if (brick->IsQuiescent()) {
+            int connectionsNb = brick->GetProcessesConnectionsNb();
+            std::fill(rates + iRate, rates + iRate + connectionsNb, 0);
+            iRate += connectionsNb;
+            continue;
+        }
         double sumRates = 0.0;
         for (auto process : brick->GetProcesses()) {
             // Get the change rates (per day) independently of the time step and constraints (null bricks handled)
-            vecDouble rates = process->GetChangeRates();
-
-            for (int i = 0; i < rates.size(); ++i) {
-                wxASSERT(m_changeRates.rows() > iRate);
-                m_changeRates(iRate, col) = rates[i];
-                sumRates += rates[i];
+            int connectionsNb = process->GetConnectionsNb();
+            wxASSERT(m_changeRates.rows() >= iRate + connectionsNb);
+            ComputeKernelRates(kernels[iRate], &rates[iRate]);
 
-                // Link to fluxes to enforce subsequent constraints
-                if (applyConstraints) {
-                    process->StoreInOutgoingFlux(&m_changeRates(iRate, col), i);
-                }
+            for (int i = 0; i < connectionsNb; ++i) {
+                sumRates += rates[iRate];
                 iRate++;
             }
         }
 
+        if (!applyConstraints) {
+            continue;
+        }
+
         // Apply constraints for the current brick (e.g. maximum capacity or avoid negative values)
-        if (applyConstraints && sumRates > PRECISION) {
-            brick->ApplyConstraints(g_timeStepInDays);
+        NullOverflowRates(table, iBrick, rates);
+        if (sumRates > PRECISION) {
+            for (int i = table.bricksStart[iBrick]; i < table.bricksStart[iBrick + 1]; ++i) {
+                ApplyContainerConstraint(table, table.constraints[i], rates, m_timeStepInDays);
+            }
         }
     }
 }
 
 void Solver::ApplyConstraintsFor(int col) {
     wxASSERT(m_processor);
-    int iRate = 0;
-    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
-        for (auto process : brick->GetProcesses()) {
-            for (int i = 0; i < process->GetConnectionsNb(); ++i) {
-                wxASSERT(m_changeRates.rows() > iRate);
-                // Link to fluxes to enforce subsequent constraints
-                process->StoreInOutgoingFlux(&m_changeRates(iRate, col), i);
-                iRate++;
-            }
+    m_processor->ForEachBlock([this, col](const ProcessingBlock& block) { ApplyConstraintsFor(block, col); });
+}
+
+void Solver::ApplyConstraintsFor(const ProcessingBlock& block, int col) {
+    vector<Brick*>& bricks = *(m_processor->GetIterableBricksVectorPt());
+    const ConstraintTable& table = *(m_processor->GetConstraintTable());
+    double* rates = m_changeRates.col(col).data();
+    for (int iBrick = block.bricksStart; iBrick < block.bricksEnd; ++iBrick) {
+        if (bricks[iBrick]->IsQuiescent()) {
+            continue;
         }
         // Apply constraints for the current brick (e.g. maximum capacity or avoid negative values)
-        brick->ApplyConstraints(g_timeStepInDays);
+        NullOverflowRates(table, iBrick, rates);
+        for (int i = table.bricksStart[iBrick]; i < table.bricksStart[iBrick + 1]; ++i) {
+            ApplyContainerConstraint(table, table.constraints[i], rates, m_timeStepInDays);
+        }
     }
 }
 
 void Solver::ResetStateVariableChanges() {
     wxASSERT(m_processor);
-    for (auto value : *(m_processor->GetStateVariablesVectorPt())) {
-        *value = 0;
-    }
+    m_processor->ForEachBlock([this](const ProcessingBlock& block) { ResetStateVariableChanges(block); });
+}
+
+void Solver::ResetStateVariableChanges(const ProcessingBlock& block) {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    int start = block.stateVariablesStart;
+    int size = block.stateVariablesEnd - start;
+    values.segment(start, size).setZero();
 }
 
 void Solver::SetStateVariablesToIteration(int col) {
     wxASSERT(m_processor);
-    int counter = 0;
-    for (auto value : *(m_processor->GetStateVariablesVectorPt())) {
-        *value = m_stateVariableChanges(counter, col);
-        counter++;
-    }
+    m_processor->ForEachBlock([this, col](const ProcessingBlock& block) { SetStateVariablesToIteration(block, col); });
+}
+
+void Solver::SetStateVariablesToIteration(const ProcessingBlock& block, int col) {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    int start = block.stateVariablesStart;
+    int size = block.stateVariablesEnd - start;
+    values.segment(start, size) = m_stateVariableChanges.col(col).segment(start, size);
 }
 
 void Solver::SetStateVariablesToAvgOf(int col1, int col2) {
     wxASSERT(m_processor);
-    int counter = 0;
-    for (auto value : *(m_processor->GetStateVariablesVectorPt())) {
-        *value = (m_stateVariableChanges(counter, col1) + m_stateVariableChanges(counter, col2)) / 2.0;
-        counter++;
-    }
+    m_processor->ForEachBlock(
+        [this, col1, col2](const ProcessingBlock& block) { SetStateVariablesToAvgOf(block, col1, col2); });
+}
+
+void Solver::SetStateVariablesToAvgOf(const ProcessingBlock& block, int col1, int col2) {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    int start = block.stateVariablesStart;
+    int size = block.stateVariablesEnd - start;
+    values.segment(start, size) = (m_stateVariableChanges.col(col1).segment(start, size) +
+                                   m_stateVariableChanges.col(col2).segment(start, size)) /
+                                  2.0;
+}
+
+void Solver::ApplyProcesses(int col) {
+    wxASSERT(m_processor);
+    const double* changeRates = m_changeRates.col(col).data();
+    m_processor->ForEachBlock(
+        [this, changeRates](const ProcessingBlock& block) { ApplyProcesses(block, changeRates); });
 }
 
-void Solver::ApplyProcesses(int col) const {
+void Solver::ApplyProcesses(const axd& changeRates) {
     wxASSERT(m_processor);
-    int iRate = 0;
-    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
-        if (brick->IsNull()) {
+    wxASSERT(changeRates.size() == m_changeRates.rows());
+    const double* rates = changeRates.data();
+    m_processor->ForEachBlock([this, rates](const ProcessingBlock& block) { ApplyProcesses(block, rates); });
+}
+
+void Solver::ApplyProcesses(const ProcessingBlock& block, const double* changeRates) {
+    vector<Brick*>& bricks = *(m_processor->GetIterableBricksVectorPt());
+    int iRate = block.ratesStart;
+    for (int iBrick = block.bricksStart; iBrick < block.bricksEnd; ++iBrick) {
+        Brick* brick = bricks[iBrick];
+        if (brick->IsNull() || brick->IsQuiescent()) {
+            iRate += brick->GetProcessesConnectionsNb();
+            continue;
+        }
+        if (brick->UsesAnalyticalIntegration()) {
+            ApplyLinearOutflowsAnalytically(brick);
+            iRate += brick->GetProcessesConnectionsNb();
+            continue;
+        }
+        if (brick->GetSubStepsNb() > 1) {
+            ApplySubSteps(brick, iRate);
+            iRate += brick->GetProcessesConnectionsNb();
             continue;
         }
         brick->UpdateContentFromInputs();
         for (auto process : brick->GetProcesses()) {
             for (int iConnect = 0; iConnect < process->GetConnectionsNb(); ++iConnect) {
-                process->ApplyChange(iConnect, m_changeRates(iRate, col), g_timeStepInDays);
+                process->ApplyChange(iConnect, changeRates[iRate], m_timeStepInDays);
                 iRate++;
             }
         }
     }
 }
 
-void Solver::ApplyProcesses(const axd& changeRates) const {
-    wxASSERT(m_processor);
-    int iRate = 0;
-    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
-        if (brick->IsNull()) {
-            continue;
+void Solver::ApplyLinearOutflowsAnalytically(Brick* brick) const {
+    WaterContainer* container = brick->GetWaterContainer();
+    double initialContent = container->GetContentWithChanges();
+    brick->UpdateContentFromInputs();
+    double inputs = container->GetContentWithChanges() - initialContent;
+
+    double sumFactors = 0;
+    for (auto process : brick->GetProcesses()) {
+        sumFactors += process->GetResponseFactor();
+    }
+
+    // Exact solution of dS/dt = i - k S with a constant input rate i
+    double dt = m_timeStepInDays;
+    double outflow = 0;
+    if (sumFactors > 0) {
+        double equilibrium = inputs / (dt * sumFactors);
+        double finalContent = equilibrium + (initialContent - equilibrium) * std::exp(-sumFactors * dt);
+        outflow = wxMax(initialContent + inputs - finalContent, 0.0);
+    }
+
+    // Share the outflow between the processes proportionally to their response factor
+    for (auto process : brick->GetProcesses()) {
+        double rate = 0;
+        if (sumFactors > 0) {
+            rate = process->GetResponseFactor() / sumFactors * outflow / dt;
         }
-        brick->UpdateContentFromInputs();
+        process->ApplyChange(0, rate, dt);
+    }
+}
+
+void Solver::ApplySubSteps(Brick* brick, int iRate) {
+    vector<RateKernel>& kernels = *(m_processor->GetRateKernelsVectorPt());
+    WaterContainer* container = brick->GetWaterContainer();
+
+    // Spread the inputs evenly over the sub steps
+    double initialContent = container->GetContentWithChanges();
+    brick->UpdateContentFromInputs();
+    double inputs = container->GetContentWithChanges() - initialContent;
+    container->SubtractAmountFromDynamicContentChange(inputs);
+
+    int subStepsNb = brick->GetSubStepsNb();
+    int connectionsNb = brick->GetProcessesConnectionsNb();
+    double dt = m_timeStepInDays / subStepsNb;
+    double* rates = &m_subStepRates(iRate);
+    double* amounts = &m_subStepAmounts(iRate);
+    std::fill(amounts, amounts + connectionsNb, 0);
+
+    for (int iStep = 0; iStep < subStepsNb; ++iStep) {
+        container->AddAmountToDynamicContentChange(inputs / subStepsNb);
+
+        int iConnect = 0;
         for (auto process : brick->GetProcesses()) {
-            for (int iConnect = 0; iConnect < process->GetConnectionsNb(); ++iConnect) {
-                process->ApplyChange(iConnect, changeRates(iRate), g_timeStepInDays);
-                iRate++;
-            }
+            ComputeKernelRates(kernels[iRate + iConnect], &rates[iConnect]);
+            iConnect += process->GetConnectionsNb();
+        }
+
+        // Avoid negative content
+        double outputs = 0;
+        for (int i = 0; i < connectionsNb; ++i) {
+            rates[i] = wxMax(rates[i], 0.0);
+            outputs += rates[i];
+        }
+        double content = container->GetContentWithChanges();
+        double factor = 1.0;
+        if (outputs * dt > content) {
+            factor = wxMax(content, 0.0) / (outputs * dt);
+        }
+
+        double outflow = 0;
+        for (int i = 0; i < connectionsNb; ++i) {
+            amounts[i] += factor * rates[i] * dt;
+            outflow += factor * rates[i] * dt;
+        }
+        container->SubtractAmountFromDynamicContentChange(outflow);
+    }
+
+    // Apply the mean rates over the time step (the content is restored as it is subtracted again)
+    int iConnect = 0;
+    for (auto process : brick->GetProcesses()) {
+        for (int i = 0; i < process->GetConnectionsNb(); ++i) {
+            container->AddAmountToDynamicContentChange(amounts[iConnect]);
+            process->ApplyChange(i, amounts[iConnect] / m_timeStepInDays, m_timeStepInDays);
+            iConnect++;
         }
     }
 }
 
 void Solver::Finalize() const {
     wxASSERT(m_processor);
-    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
-        if (brick->IsNull()) {
+    m_processor->ForEachBlock([this](const ProcessingBlock& block) { Finalize(block); });
+}
+
+void Solver::Finalize(const ProcessingBlock& block) const {
+    vector<Brick*>& bricks = *(m_processor->GetIterableBricksVectorPt());
+    for (int iBrick = block.bricksStart; iBrick < block.bricksEnd; ++iBrick) {
+        Brick* brick = bricks[iBrick];
+        if (brick->IsNull() || brick->IsQuiescent()) {
             continue;
         }
         brick->Finalize();
@@ -4,7 +4,9 @@
 #include "Includes.h"
 #include "SettingsModel.h"
 
+class Brick;
 class Processor;
+struct ProcessingBlock;
 
 class Solver : public wxObject {
   public:
@@ -36,15 +38,38 @@ class Solver : public wxObject {
     }
 
     /**
-     * Initialize the internal containers to the needed size.
+     * Initialize the internal containers to the needed size. Called every time the processing tables are rebuilt.
      */
-    void InitializeContainers();
+    virtual void InitializeContainers();
+
+    /**
+     * Reset the values carried by the solver from one time step to the next, so that a run does not depend on the
+     * previous ones.
+     */
+    virtual void Reset() {}
+
+    /**
+     * Check if the sequence of the operations on the processing blocks is the same for every time step (no
+     * adaptive sub-steps nor iterations depending on the state of the whole model).
+     *
+     * @return True if the sequence is fixed.
+     */
+    virtual bool HasFixedStages() const {
+        return true;
+    }
+
+    axxd* GetChangeRates() {
+        return &m_changeRates;
+    }
 
   protected:
     Processor* m_processor;
     axxd m_stateVariableChanges;
     axxd m_changeRates;
+    axd m_subStepRates;
+    axd m_subStepAmounts;
     int m_nIterations;
+    double m_timeStepInDays;
 
     /**
      * Save the state variables.
@@ -91,14 +116,14 @@ class Solver : public wxObject {
      *
      * @param col The column (= iteration) of the internal storage containing the change rates to use.
      */
-    void ApplyProcesses(int col) const;
+    void ApplyProcesses(int col);
 
     /**
      * Apply the changes to the processes using the provided change rates.
      *
      * @param changeRates The change rate values to use.
      */
-    void ApplyProcesses(const axd& changeRates) const;
+    void ApplyProcesses(const axd& changeRates);
 
     /**
      * Apply all changes.
@@ -106,6 +131,38 @@ class Solver : public wxObject {
     void Finalize() const;
 
   private:
+    void SaveStateVariables(const ProcessingBlock& block, int col);
+
+    void ComputeChangeRates(const ProcessingBlock& block, int col, bool applyConstraints);
+
+    void ApplyConstraintsFor(const ProcessingBlock& block, int col);
+
+    void ResetStateVariableChanges(const ProcessingBlock& block);
+
+    void SetStateVariablesToIteration(const ProcessingBlock& block, int col);
+
+    void SetStateVariablesToAvgOf(const ProcessingBlock& block, int col1, int col2);
+
+    void ApplyProcesses(const ProcessingBlock& block, const double* changeRates);
+
+    /**
+     * Apply the exact changes of a brick emptied only by linear outflows, assuming constant inputs over the time
+     * step. The change rates computed by the solver stages are ignored.
+     *
+     * @param brick The brick to process.
+     */
+    void ApplyLinearOutflowsAnalytically(Brick* brick) const;
+
+    /**
+     * Apply the changes of a brick of the fast partition by sub-cycling it with explicit Euler sub steps, assuming
+     * constant inputs over the time step. The change rates computed by the solver stages are ignored.
+     *
+     * @param brick The brick to process.
+     * @param iRate The index of the first change rate of the brick.
+     */
+    void ApplySubSteps(Brick* brick, int iRate);
+
+    void Finalize(const ProcessingBlock& block) const;
 };
 
 #endif  // HYDROBRICKS_SOLVER_H
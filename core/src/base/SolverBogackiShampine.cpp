@@ -0,0 +1,144 @@
+#include "SolverBogackiShampine.h"
+
+#include "Processor.h"
+
+// Limits of the sub-step size (as fraction of the time step) and of its change between sub-steps.
+static const double MIN_SUB_STEP = 0.001;
+static const double MIN_STEP_FACTOR = 0.2;
+static const double MAX_STEP_FACTOR = 5.0;
+static const double SAFETY_FACTOR = 0.9;
+
+SolverBogackiShampine::SolverBogackiShampine(double absoluteTolerance, double relativeTolerance)
+    : Solver(),
+      m_absoluteTolerance(absoluteTolerance),
+      m_relativeTolerance(relativeTolerance),
+      m_subStep(1.0),
+      m_subStepsNb(0) {
+    // Change rates: k1, k2, k3, k4 and the mean rate of the accepted sub-steps.
+    // State variables: changes resulting from k1 to k4 over the time step, sub-step start (base) and end.
+    m_nIterations = 6;
+}
+
+void SolverBogackiShampine::Reset() {
+    m_subStep = 1.0;
+}
+
+bool SolverBogackiShampine::Solve() {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    vector<WaterContainer*>& containers = *(m_processor->GetStateContainersVectorPt());
+
+    // Store the contents at the beginning of the time step to scale the errors
+    m_contents.resize(Eigen::Index(containers.size()));
+    for (int i = 0; i < containers.size(); ++i) {
+        m_contents(i) = containers[i]->GetContentWithChanges();
+    }
+
+    // Compute the change rates for k1 = f(tn, Sn)
+    m_stateVariableChanges.col(4).setZero();
+    m_changeRates.col(4).setZero();
+    ComputeChangeRates(0, false);
+    ComputeStateVariableChanges(0, 0);
+
+    double done = 0;
+    double subStep = m_subStep;
+    m_subStepsNb = 0;
+
+    while (true) {
+        bool lastSubStep = subStep >= 1.0 - done - PRECISION;
+        if (lastSubStep) {
+            subStep = 1.0 - done;
+        }
+
+        // Compute k2 = f(tn + h/2, Sn + k1 h/2)
+        values = m_stateVariableChanges.col(4) + subStep / 2.0 * m_stateVariableChanges.col(0);
+        ComputeChangeRates(1, false);
+        ComputeStateVariableChanges(1, 1);
+
+        // Compute k3 = f(tn + 3h/4, Sn + k2 3h/4)
+        values = m_stateVariableChanges.col(4) + 3.0 * subStep / 4.0 * m_stateVariableChanges.col(1);
+        ComputeChangeRates(2, false);
+        ComputeStateVariableChanges(2, 2);
+
+        // 3rd order solution and k4 = f(tn + h, Sn+1), reused as k1 of the next sub-step
+        m_stateVariableChanges.col(5) = m_stateVariableChanges.col(4) +
+                                        subStep * (2.0 / 9.0 * m_stateVariableChanges.col(0) +
+                                                   1.0 / 3.0 * m_stateVariableChanges.col(1) +
+                                                   4.0 / 9.0 * m_stateVariableChanges.col(2));
+        values = m_stateVariableChanges.col(5);
+        ComputeChangeRates(3, false);
+        ComputeStateVariableChanges(3, 3);
+
+        double error = ComputeErrorNorm(subStep);
+        double factor = MAX_STEP_FACTOR;
+        if (error > 0) {
+            factor = std::min(MAX_STEP_FACTOR, std::max(MIN_STEP_FACTOR, SAFETY_FACTOR * std::pow(error, -1.0 / 3.0)));
+        }
+
+        double nextSubStep = std::max(subStep * factor, MIN_SUB_STEP);
+        m_subStep = std::min(nextSubStep, 1.0);
+
+        if (error <= 1.0 || subStep <= MIN_SUB_STEP) {
+            m_changeRates.col(4) += subStep * (2.0 / 9.0 * m_changeRates.col(0) + 1.0 / 3.0 * m_changeRates.col(1) +
+                                               4.0 / 9.0 * m_changeRates.col(2));
+            m_stateVariableChanges.col(4) = m_stateVariableChanges.col(5);
+            m_changeRates.col(0) = m_changeRates.col(3);
+            m_stateVariableChanges.col(0) = m_stateVariableChanges.col(3);
+            done += subStep;
+            m_subStepsNb++;
+
+            if (lastSubStep) {
+                break;
+            }
+        }
+
+        subStep = nextSubStep;
+    }
+
+    // Reset state variable changes to 0
+    ResetStateVariableChanges();
+
+    // Apply the mean change rate of the sub-steps
+    ApplyConstraintsFor(4);
+    ApplyProcesses(4);
+    Finalize();
+
+    return true;
+}
+
+void SolverBogackiShampine::ComputeStateVariableChanges(int colRates, int colStates) {
+    ResetStateVariableChanges();
+    ApplyProcesses(colRates);
+    SaveStateVariables(colStates);
+}
+
+double SolverBogackiShampine::ComputeErrorNorm(double subStep) {
+    // Difference between the 3rd and the 2nd order solutions
+    static const double e1 = 2.0 / 9.0 - 7.0 / 24.0;
+    static const double e2 = 1.0 / 3.0 - 1.0 / 4.0;
+    static const double e3 = 4.0 / 9.0 - 1.0 / 3.0;
+    static const double e4 = -1.0 / 8.0;
+
+    // Error on the state variables (infinite storages have infinite scales)
+    double error = 0;
+    for (Eigen::Index i = 0; i < m_stateVariableChanges.rows(); ++i) {
+        double stateError = subStep * (e1 * m_stateVariableChanges(i, 0) + e2 * m_stateVariableChanges(i, 1) +
+                                       e3 * m_stateVariableChanges(i, 2) + e4 * m_stateVariableChanges(i, 3));
+        double contentStart = std::abs(m_contents(i) + m_stateVariableChanges(i, 4));
+        double contentEnd = std::abs(m_contents(i) + m_stateVariableChanges(i, 5));
+        double stateScale = m_absoluteTolerance + m_relativeTolerance * std::max(contentStart, contentEnd);
+        error = std::max(error, std::abs(stateError) / stateScale);
+    }
+
+    // Error on the water amounts transferred by the fluxes (including the outlet)
+    double subStepInDays = subStep * m_timeStepInDays;
+    for (Eigen::Index i = 0; i < m_changeRates.rows(); ++i) {
+        double fluxError = subStepInDays * (e1 * m_changeRates(i, 0) + e2 * m_changeRates(i, 1) +
+                                            e3 * m_changeRates(i, 2) + e4 * m_changeRates(i, 3));
+        double fluxAmount = subStepInDays * (2.0 / 9.0 * m_changeRates(i, 0) + 1.0 / 3.0 * m_changeRates(i, 1) +
+                                             4.0 / 9.0 * m_changeRates(i, 2));
+        double fluxScale = m_absoluteTolerance + m_relativeTolerance * std::abs(fluxAmount);
+        error = std::max(error, std::abs(fluxError) / fluxScale);
+    }
+
+    return error;
+}
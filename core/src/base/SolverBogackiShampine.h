@@ -0,0 +1,74 @@
+#ifndef HYDROBRICKS_SOLVER_BOGACKI_SHAMPINE_H
+#define HYDROBRICKS_SOLVER_BOGACKI_SHAMPINE_H
+
+#include "Includes.h"
+#include "Solver.h"
+#include "SubBasin.h"
+
+/**
+ * Adaptive Bogacki–Shampine 3(2) solver. The time step is divided into sub-steps which size is controlled by the
+ * difference between the embedded 3rd and 2nd order solutions, evaluated on the state variables and on the water
+ * amounts transferred by the fluxes (including those leaving to the outlet or the atmosphere). The changes
+ * resulting from the accepted sub-steps are applied at the end of the time step as a single mean change rate.
+ */
+class SolverBogackiShampine : public Solver {
+  public:
+    /**
+     * @param absoluteTolerance The absolute error tolerance [mm].
+     * @param relativeTolerance The relative error tolerance [-].
+     */
+    explicit SolverBogackiShampine(double absoluteTolerance = 0.001, double relativeTolerance = 0.001);
+
+    /**
+     * @copydoc Solver::Solve()
+     */
+    bool Solve() override;
+
+    /**
+     * @copydoc Solver::HasFixedStages()
+     */
+    bool HasFixedStages() const override {
+        return false;
+    }
+
+    /**
+     * Get the number of sub-steps accepted during the last time step.
+     *
+     * @return The number of accepted sub-steps.
+     */
+    int GetSubStepsNb() const {
+        return m_subStepsNb;
+    }
+
+    /**
+     * Restart from a sub-step covering the whole time step.
+     */
+    void Reset() override;
+
+  protected:
+    double m_absoluteTolerance;
+    double m_relativeTolerance;
+    double m_subStep;
+    int m_subStepsNb;
+    axd m_contents;
+
+  private:
+    /**
+     * Compute the state variable changes over the full time step resulting from the change rates of the provided
+     * column and store them.
+     *
+     * @param colRates The column of the change rates to apply.
+     * @param colStates The column where the resulting state variable changes must be saved.
+     */
+    void ComputeStateVariableChanges(int colRates, int colStates);
+
+    /**
+     * Compute the normalized error of the current sub-step.
+     *
+     * @param subStep The sub-step size as a fraction of the time step.
+     * @return The error norm (<= 1 if the sub-step is acceptable).
+     */
+    double ComputeErrorNorm(double subStep);
+};
+
+#endif  // HYDROBRICKS_SOLVER_BOGACKI_SHAMPINE_H
@@ -0,0 +1,111 @@
+#include "SolverEulerImplicit.h"
+
+#include <unordered_map>
+
+#include "Processor.h"
+
+// Newton iteration settings (tolerance in mm).
+static const int MAX_NEWTON_ITERATIONS = 20;
+static const double NEWTON_TOLERANCE = 0.000000001;
+static const double NEWTON_PERTURBATION = 0.000001;
+
+SolverEulerImplicit::SolverEulerImplicit()
+    : Solver(),
+      m_newtonIterationsNb(0) {
+    // Change rates: at the current estimate and at the perturbed estimate.
+    m_nIterations = 2;
+}
+
+bool SolverEulerImplicit::Solve() {
+    axd& values = *(m_processor->GetStateVariableChanges());
+    vector<WaterContainer*>& containers = *(m_processor->GetStateContainersVectorPt());
+
+    // Store the contents at the beginning of the time step
+    auto statesNb = Eigen::Index(containers.size());
+    m_contents.resize(statesNb);
+    for (int i = 0; i < statesNb; ++i) {
+        m_contents(i) = containers[i]->GetContentWithChanges();
+    }
+
+    // Solve G(S) = S - Sn - dt f(S) = 0 for the state variable changes
+    m_changes = axd::Zero(statesNb);
+    m_derivatives.resize(statesNb);
+    for (m_newtonIterationsNb = 1; m_newtonIterationsNb <= MAX_NEWTON_ITERATIONS; ++m_newtonIterationsNb) {
+        // Compute the change rates and the resulting changes for the current estimate
+        values = m_changes;
+        ComputeChangeRates(0, false);
+        ResetStateVariableChanges();
+        ApplyProcesses(0);
+        SaveStateVariables(0);
+
+        // Compute the change rates for the perturbed estimate (infinite storages are not perturbed)
+        m_perturbations = NEWTON_PERTURBATION * (m_contents + m_changes).abs().max(1.0);
+        m_perturbations = m_contents.isFinite().select(m_perturbations, 0.0);
+        values = m_changes + m_perturbations;
+        ComputeChangeRates(1, false);
+
+        // Derivative of the outgoing rates of each container with respect to its content
+        m_derivatives.setZero();
+        for (int iRate = 0; iRate < m_rateSources.size(); ++iRate) {
+            int iState = m_rateSources[iRate];
+            if (iState >= 0 && m_perturbations(iState) > 0) {
+                m_derivatives(iState) += (m_changeRates(iRate, 1) - m_changeRates(iRate, 0)) / m_perturbations(iState);
+            }
+        }
+
+        // Newton update using the diagonal of the Jacobian: dG/dS = 1 + dt df/dS
+        axd update = (m_changes - m_stateVariableChanges.col(0)) / (1.0 + m_timeStepInDays * m_derivatives.max(0.0));
+        m_changes -= update;
+
+        // Keep the contents positive
+        m_changes = m_changes.max(-m_contents);
+
+        if (update.size() == 0 || update.abs().maxCoeff() < NEWTON_TOLERANCE) {
+            break;
+        }
+    }
+
+    // Compute the change rates at the end of the time step
+    values = m_changes;
+    ComputeChangeRates(0, false);
+
+    // Reset state variable changes to 0
+    ResetStateVariableChanges();
+
+    // Apply the final rates
+    ApplyConstraintsFor(0);
+    ApplyProcesses(0);
+    Finalize();
+
+    return true;
+}
+
+void SolverEulerImplicit::InitializeContainers() {
+    Solver::InitializeContainers();
+
+    // The state variables are reordered when the active bricks change.
+    MapRatesToStateVariables();
+}
+
+void SolverEulerImplicit::MapRatesToStateVariables() {
+    vector<WaterContainer*>& containers = *(m_processor->GetStateContainersVectorPt());
+    std::unordered_map<WaterContainer*, int> stateIndices;
+    for (int i = 0; i < containers.size(); ++i) {
+        stateIndices[containers[i]] = i;
+    }
+
+    m_rateSources.clear();
+    for (auto brick : *(m_processor->GetIterableBricksVectorPt())) {
+        for (auto process : brick->GetProcesses()) {
+            int iState = -1;
+            auto it = stateIndices.find(process->GetWaterContainer());
+            if (it != stateIndices.end()) {
+                iState = it->second;
+            }
+            for (int i = 0; i < process->GetConnectionsNb(); ++i) {
+                m_rateSources.push_back(iState);
+            }
+        }
+    }
+    wxASSERT(m_rateSources.size() == m_changeRates.rows());
+}
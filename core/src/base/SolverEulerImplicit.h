@@ -0,0 +1,67 @@
+#ifndef HYDROBRICKS_SOLVER_EULER_IMPLICIT_H
+#define HYDROBRICKS_SOLVER_EULER_IMPLICIT_H
+
+#include "Includes.h"
+#include "Solver.h"
+#include "SubBasin.h"
+
+/**
+ * Implicit (backward) Euler solver for stiff systems (e.g., fast reservoirs). The state at the end of the time step
+ * is found by a Newton iteration using the diagonal of the Jacobian, i.e. the derivative of the outgoing rates of
+ * each water container with respect to its own content, estimated by finite differences.
+ */
+class SolverEulerImplicit : public Solver {
+  public:
+    explicit SolverEulerImplicit();
+
+    /**
+     * @copydoc Solver::Solve()
+     */
+    bool Solve() override;
+
+    /**
+     * @copydoc Solver::HasFixedStages()
+     */
+    bool HasFixedStages() const override {
+        return false;
+    }
+
+    /**
+     * Get the number of Newton iterations performed during the last time step.
+     *
+     * @return The number of Newton iterations.
+     */
+    int GetNewtonIterationsNb() const {
+        return m_newtonIterationsNb;
+    }
+
+    /**
+     * Get the index of the state variable depleted by every change rate.
+     *
+     * @return The indices of the state variables (-1 for rates not depleting a state variable).
+     */
+    const vecInt& GetRateSources() const {
+        return m_rateSources;
+    }
+
+    /**
+     * @copydoc Solver::InitializeContainers()
+     */
+    void InitializeContainers() override;
+
+  protected:
+    vecInt m_rateSources;
+    axd m_contents;
+    axd m_changes;
+    axd m_perturbations;
+    axd m_derivatives;
+    int m_newtonIterationsNb;
+
+  private:
+    /**
+     * Assign to every change rate the index of the state variable it depletes.
+     */
+    void MapRatesToStateVariables();
+};
+
+#endif  // HYDROBRICKS_SOLVER_EULER_IMPLICIT_H
@@ -25,7 +25,7 @@ bool SolverHeunExplicit::Solve() {
 
     // Apply the changes
     ApplyConstraintsFor(2);
-    ApplyProcesses(m_changeRates.col(2));
+    ApplyProcesses(2);
     Finalize();
 
     return true;
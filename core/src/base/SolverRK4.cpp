@@ -64,7 +64,7 @@ bool SolverRK4::Solve() {
 
     // Apply the final rates
     ApplyConstraintsFor(4);
-    ApplyProcesses(m_changeRates.col(4));
+    ApplyProcesses(4);
     Finalize();
 
     return true;
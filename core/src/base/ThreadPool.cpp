@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadsNb)
+    : m_task(nullptr),
+      m_nextIndex(0),
+      m_count(0),
+      m_activeWorkers(0),
+      m_generation(0),
+      m_stop(false) {
+    for (int i = 1; i < threadsNb; ++i) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+
+    // No need to wake up the workers for a single task.
+    if (m_workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_nextIndex = 0;
+        m_activeWorkers = int(m_workers.size());
+        m_exception = nullptr;
+        m_generation++;
+    }
+    m_wakeUp.notify_all();
+
+    RunTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_activeWorkers == 0; });
+    m_task = nullptr;
+
+    if (m_exception) {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    int generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [this, generation] { return m_stop || m_generation != generation; });
+            if (m_stop) {
+                return;
+            }
+            generation = m_generation;
+        }
+
+        RunTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeWorkers--;
+        }
+        m_done.notify_one();
+    }
+}
+
+void ThreadPool::RunTasks() {
+    int index;
+    while ((index = m_nextIndex.fetch_add(1)) < m_count) {
+        try {
+            (*m_task)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_exception) {
+                m_exception = std::current_exception();
+            }
+            // Skip the remaining tasks.
+            m_nextIndex = m_count;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef HYDROBRICKS_THREAD_POOL_H
+#define HYDROBRICKS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Includes.h"
+
+class ThreadPool : public wxObject {
+  public:
+    /**
+     * Create a pool of persistent worker threads.
+     *
+     * @param threadsNb The total number of threads to use, including the calling thread.
+     */
+    explicit ThreadPool(int threadsNb);
+
+    ~ThreadPool() override;
+
+    /**
+     * Run the task for every index in [0, count[ and wait until all of them are done. The calling thread
+     * participates to the work. The first exception thrown by a task is rethrown in the calling thread.
+     *
+     * @param count The number of tasks to run.
+     * @param task The task to run, taking the index as argument.
+     */
+    void ParallelFor(int count, const std::function<void(int)>& task);
+
+    int GetThreadsNb() const {
+        return int(m_workers.size()) + 1;
+    }
+
+  protected:
+    vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_done;
+    const std::function<void(int)>* m_task;
+    std::atomic<int> m_nextIndex;
+    int m_count;
+    int m_activeWorkers;
+    int m_generation;
+    bool m_stop;
+    std::exception_ptr m_exception;
+
+  private:
+    void WorkerLoop();
+
+    void RunTasks();
+};
+
+#endif  // HYDROBRICKS_THREAD_POOL_H
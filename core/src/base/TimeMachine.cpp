@@ -63,6 +63,11 @@ int TimeMachine::GetTimeStepsNb() {
     return int(1 + (m_end - m_start) / m_timeStepInDays);
 }
 
+int TimeMachine::GetTimeStepIndex() {
+    wxASSERT(m_timeStepInDays > 0);
+    return int(std::round((m_date - m_start) / m_timeStepInDays));
+}
+
 void TimeMachine::UpdateTimeStepInDays() {
     switch (m_timeStepUnit) {
         case Variable:
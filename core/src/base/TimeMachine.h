@@ -24,12 +24,23 @@ class TimeMachine : public wxObject {
 
     int GetTimeStepsNb();
 
+    /**
+     * Get the index of the current time step (0 for the start date).
+     *
+     * @return The index of the current time step.
+     */
+    int GetTimeStepIndex();
+
     void UpdateTimeStepInDays();
 
     double GetDate() {
         return m_date;
     }
 
+    void SetDate(double date) {
+        m_date = date;
+    }
+
     double GetStart() {
         return m_start;
     }
@@ -1,13 +1,20 @@
 #include "TimeSeries.h"
 
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "FileMapped.h"
 #include "FileNetcdf.h"
 #include "TimeSeriesDistributed.h"
+#include "TimeSeriesDistributedStream.h"
 #include "TimeSeriesUniform.h"
 
 TimeSeries::TimeSeries(VariableType type)
     : m_type(type) {}
 
-bool TimeSeries::Parse(const string& path, vector<TimeSeries*>& vecTimeSeries) {
+bool TimeSeries::Parse(const string& path, vector<TimeSeries*>& vecTimeSeries, int chunkSize, bool singlePrecision) {
     try {
         FileNetcdf file;
 
@@ -42,6 +49,9 @@ bool TimeSeries::Parse(const string& path, vector<TimeSeries*>& vecTimeSeries) {
 
         int dimIdTime = file.GetDimId("time");
 
+        vecStr streamedVarNames;
+        vector<VariableType> streamedVarTypes;
+
         for (int iVar = 0; iVar < varsNb; ++iVar) {
             // Get variable name
             string varName = file.GetVarName(iVar);
@@ -53,33 +63,64 @@ bool TimeSeries::Parse(const string& path, vector<TimeSeries*>& vecTimeSeries) {
             // Get forcing type
             VariableType varType = MatchVariableType(varName);
 
+            // Streamed during the simulation, once this file is closed
+            if (chunkSize > 0) {
+                streamedVarNames.push_back(varName);
+                streamedVarTypes.push_back(varType);
+                continue;
+            }
+
             // Instantiate time series
             auto timeSeries = new TimeSeriesDistributed(varType);
 
             // Retrieve values from netCDF
             vecInt dimIds = file.GetVarDimIds(iVar, 2);
 
-            if (dimIds[0] == dimIdTime) {
-                axxd values = file.GetVarDouble2D(iVar, unitsNb, timeLength);
-                for (int i = 0; i < values.rows(); ++i) {
-                    axd valuesUnit = values.row(i);
-                    auto forcingData = new TimeSeriesDataRegular(start, end, timeStep, timeUnit);
-                    forcingData->SetValues(vector<double>(valuesUnit.data(), valuesUnit.data() + valuesUnit.rows()));
-                    timeSeries->AddData(forcingData, ids[i]);
+            // Read as float in the order of the file, without intermediate copy.
+            if (singlePrecision) {
+                bool unitMajor = dimIds[0] != dimIdTime;
+                size_t blockStart[2] = {0, 0};
+                size_t blockCount[2] = {size_t(timeLength), size_t(unitsNb)};
+                if (unitMajor) {
+                    std::swap(blockCount[0], blockCount[1]);
                 }
-            } else {
-                axxd values = file.GetVarDouble2D(iVar, timeLength, unitsNb);
-                for (int i = 0; i < values.cols(); ++i) {
-                    axd valuesUnit = values.col(i);
-                    auto forcingData = new TimeSeriesDataRegular(start, end, timeStep, timeUnit);
-                    forcingData->SetValues(vector<double>(valuesUnit.data(), valuesUnit.data() + valuesUnit.rows()));
-                    timeSeries->AddData(forcingData, ids[i]);
+                auto block = std::make_shared<vecFloat>(size_t(timeLength) * unitsNb);
+                file.GetVarFloat2DBlock(iVar, blockStart, blockCount, block->data());
+                if (!timeSeries->SetValues(start, end, timeStep, timeUnit, ids,
+                                           std::shared_ptr<const void>(block, block->data()), timeLength, unitMajor,
+                                           true)) {
+                    wxDELETE(timeSeries);
+                    return false;
                 }
+                vecTimeSeries.push_back(timeSeries);
+                continue;
+            }
+
+            axxd values;
+            if (dimIds[0] == dimIdTime) {
+                values = file.GetVarDouble2D(iVar, unitsNb, timeLength).transpose();
+            } else {
+                values = file.GetVarDouble2D(iVar, timeLength, unitsNb);
+            }
+            if (!timeSeries->SetValues(start, end, timeStep, timeUnit, ids, values)) {
+                wxDELETE(timeSeries);
+                return false;
             }
 
             vecTimeSeries.push_back(timeSeries);
         }
 
+        // The streams read the file on background threads, which cannot overlap with other NetCDF calls.
+        file.Close();
+        for (int i = 0; i < streamedVarNames.size(); ++i) {
+            auto timeSeries = new TimeSeriesDistributedStream(streamedVarTypes[i]);
+            if (!timeSeries->Open(path, streamedVarNames[i], chunkSize, start, end, timeStep, timeUnit, ids)) {
+                wxDELETE(timeSeries);
+                return false;
+            }
+            vecTimeSeries.push_back(timeSeries);
+        }
+
     } catch (std::exception& e) {
         wxLogError(e.what());
         return false;
@@ -88,7 +129,8 @@ bool TimeSeries::Parse(const string& path, vector<TimeSeries*>& vecTimeSeries) {
     return true;
 }
 
-TimeSeries* TimeSeries::Create(const string& varName, const axd& time, const axi& ids, const axxd& data) {
+TimeSeries* TimeSeries::Create(const string& varName, const axd& time, const axi& ids, const axxd& data,
+                               bool singlePrecision) {
     // Get time
     Time startSt = GetTimeStructFromMJD(time[0]);
     Time endSt = GetTimeStructFromMJD(time[time.size() - 1]);
@@ -113,18 +155,248 @@ TimeSeries* TimeSeries::Create(const string& varName, const axd& time, const axi
                                                int(data.rows()), int(time.size()), int(data.cols()), int(ids.size())));
     }
 
-    for (int i = 0; i < data.cols(); ++i) {
-        axd valuesUnit = data.col(i);
-        auto forcingData = new TimeSeriesDataRegular(start, end, timeStep, timeUnit);
-        if (!forcingData->SetValues(vector<double>(valuesUnit.data(), valuesUnit.data() + valuesUnit.rows()))) {
-            throw InvalidArgument("Time series creation failed.");
-        }
-        timeSeries->AddData(forcingData, ids[i]);
+    if (!timeSeries->SetValues(start, end, timeStep, timeUnit, vecInt(ids.data(), ids.data() + ids.size()), data,
+                               singlePrecision)) {
+        wxDELETE(timeSeries);
+        throw InvalidArgument("Time series creation failed.");
     }
 
     return timeSeries;
 }
 
+TimeSeries* TimeSeries::Create(const string& varName, const axd& time, const axi& ids,
+                               std::shared_ptr<const void> data, bool unitMajor, bool singlePrecision) {
+    wxASSERT(data);
+
+    // Get time
+    Time startSt = GetTimeStructFromMJD(time[0]);
+    Time endSt = GetTimeStructFromMJD(time[time.size() - 1]);
+    double start = GetMJD(startSt.year, startSt.month, startSt.day, startSt.hour, startSt.min);
+    double end = GetMJD(endSt.year, endSt.month, endSt.day, endSt.hour, endSt.min);
+
+    // Time step
+    int timeStep;
+    TimeUnit timeUnit;
+    double timeStepData = time[1] - time[0];
+    ExtractTimeStep(timeStepData, timeStep, timeUnit);
+
+    auto timeSeries = new TimeSeriesDistributed(MatchVariableType(varName));
+
+    if (!timeSeries->SetValues(start, end, timeStep, timeUnit, vecInt(ids.data(), ids.data() + ids.size()),
+                               std::move(data), int(time.size()), unitMajor, singlePrecision)) {
+        wxDELETE(timeSeries);
+        throw InvalidArgument("Time series creation failed.");
+    }
+
+    return timeSeries;
+}
+
+/*
+ * Binary cache layout: header, variables table, dates (double), ids (int32) and a block of values per variable,
+ * aligned on CACHE_ALIGNMENT bytes.
+ */
+static const char CACHE_MAGIC[8] = {'H', 'B', 'F', 'O', 'R', 'C', 'E', '1'};
+static const uint32_t CACHE_VERSION = 1;
+static const uint64_t CACHE_ALIGNMENT = 64;
+static const int CACHE_NAME_LENGTH = 32;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t valueSize;
+    uint64_t timeStepsNb;
+    uint64_t unitsNb;
+    uint64_t varsNb;
+};
+
+struct CacheVariable {
+    char name[CACHE_NAME_LENGTH];
+    uint64_t offset;
+};
+
+static uint64_t AlignCacheOffset(uint64_t offset) {
+    return (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+bool TimeSeries::WriteCache(const string& path, const axd& time, const axi& ids, const vecStr& varNames,
+                            const vecAxxd& data, bool singlePrecision) {
+    if (varNames.size() != data.size()) {
+        wxLogError(_("The number of variable names (%d) does not match the number of variables (%d)."),
+                   int(varNames.size()), int(data.size()));
+        return false;
+    }
+    for (int i = 0; i < data.size(); ++i) {
+        if (data[i].rows() != time.size() || data[i].cols() != ids.size()) {
+            wxLogError(_("Dimension mismatch in the forcing data of %s."), varNames[i]);
+            return false;
+        }
+        if (varNames[i].size() >= CACHE_NAME_LENGTH) {
+            wxLogError(_("The variable name %s is too long."), varNames[i]);
+            return false;
+        }
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.valueSize = singlePrecision ? sizeof(float) : sizeof(double);
+    header.timeStepsNb = uint64_t(time.size());
+    header.unitsNb = uint64_t(ids.size());
+    header.varsNb = uint64_t(data.size());
+
+    uint64_t blockSize = header.timeStepsNb * header.unitsNb * header.valueSize;
+    uint64_t offset = sizeof(CacheHeader) + header.varsNb * sizeof(CacheVariable) +
+                      header.timeStepsNb * sizeof(double) + header.unitsNb * sizeof(int32_t);
+    vector<CacheVariable> variables(data.size());
+    for (int i = 0; i < data.size(); ++i) {
+        std::strncpy(variables[i].name, varNames[i].c_str(), CACHE_NAME_LENGTH - 1);
+        offset = AlignCacheOffset(offset);
+        variables[i].offset = offset;
+        offset += blockSize;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        wxLogError(_("The file %s could not be created."), path);
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+    file.write(reinterpret_cast<const char*>(variables.data()),
+               std::streamsize(variables.size() * sizeof(CacheVariable)));
+    file.write(reinterpret_cast<const char*>(time.data()), std::streamsize(time.size() * sizeof(double)));
+    for (int i = 0; i < ids.size(); ++i) {
+        auto id = int32_t(ids[i]);
+        file.write(reinterpret_cast<const char*>(&id), sizeof(int32_t));
+    }
+
+    // Values transposed to be contiguous by time step.
+    vector<char> row(header.unitsNb * header.valueSize);
+    for (int i = 0; i < data.size(); ++i) {
+        vector<char> padding(variables[i].offset - uint64_t(file.tellp()), 0);
+        file.write(padding.data(), std::streamsize(padding.size()));
+        for (int t = 0; t < time.size(); ++t) {
+            for (int u = 0; u < ids.size(); ++u) {
+                if (singlePrecision) {
+                    auto value = float(data[i](t, u));
+                    std::memcpy(&row[u * sizeof(float)], &value, sizeof(float));
+                } else {
+                    double value = data[i](t, u);
+                    std::memcpy(&row[u * sizeof(double)], &value, sizeof(double));
+                }
+            }
+            file.write(row.data(), std::streamsize(row.size()));
+        }
+    }
+
+    if (!file) {
+        wxLogError(_("Failed writing the file %s."), path);
+        return false;
+    }
+
+    return true;
+}
+
+bool TimeSeries::ParseCache(const string& path, vector<TimeSeries*>& vecTimeSeries) {
+    auto file = std::make_shared<FileMapped>();
+    if (!file->Open(path)) {
+        return false;
+    }
+
+    const char* data = file->GetData();
+    CacheHeader header{};
+    if (file->GetSize() < sizeof(CacheHeader)) {
+        wxLogError(_("The file %s is not a forcing cache."), path);
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(CacheHeader));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION) {
+        wxLogError(_("The file %s is not a forcing cache or its version is not supported."), path);
+        return false;
+    }
+    if ((header.valueSize != sizeof(float) && header.valueSize != sizeof(double)) || header.timeStepsNb < 2) {
+        wxLogError(_("The forcing cache %s is corrupted."), path);
+        return false;
+    }
+
+    // The counts are checked against the file size before any allocation, without overflowing the products.
+    uint64_t fileSize = file->GetSize();
+    uint64_t remaining = fileSize - sizeof(CacheHeader);
+    bool isTruncated = header.varsNb > remaining / sizeof(CacheVariable);
+    if (!isTruncated) {
+        remaining -= header.varsNb * sizeof(CacheVariable);
+        isTruncated = header.timeStepsNb > remaining / sizeof(double);
+    }
+    if (!isTruncated) {
+        remaining -= header.timeStepsNb * sizeof(double);
+        isTruncated = header.unitsNb > remaining / sizeof(int32_t) ||
+                      header.unitsNb > fileSize / (header.timeStepsNb * header.valueSize);
+    }
+    if (isTruncated) {
+        wxLogError(_("The forcing cache %s is truncated."), path);
+        return false;
+    }
+    if (header.unitsNb == 0 || header.timeStepsNb > uint64_t(std::numeric_limits<int>::max()) ||
+        header.unitsNb > uint64_t(std::numeric_limits<int>::max())) {
+        wxLogError(_("The forcing cache %s is corrupted."), path);
+        return false;
+    }
+
+    try {
+        uint64_t blockSize = header.timeStepsNb * header.unitsNb * header.valueSize;
+        uint64_t offset = sizeof(CacheHeader);
+        vector<CacheVariable> variables(header.varsNb);
+        std::memcpy(variables.data(), data + offset, header.varsNb * sizeof(CacheVariable));
+        offset += header.varsNb * sizeof(CacheVariable);
+        for (const auto& variable : variables) {
+            if (variable.offset % CACHE_ALIGNMENT != 0 || variable.offset > fileSize - blockSize) {
+                wxLogError(_("The forcing cache %s is truncated."), path);
+                return false;
+            }
+        }
+
+        vecDouble time(header.timeStepsNb);
+        std::memcpy(time.data(), data + offset, header.timeStepsNb * sizeof(double));
+        offset += header.timeStepsNb * sizeof(double);
+        vector<int32_t> ids32(header.unitsNb);
+        std::memcpy(ids32.data(), data + offset, header.unitsNb * sizeof(int32_t));
+        vecInt ids(ids32.begin(), ids32.end());
+
+        // Get time
+        Time startSt = GetTimeStructFromMJD(time[0]);
+        Time endSt = GetTimeStructFromMJD(time[time.size() - 1]);
+        double start = GetMJD(startSt.year, startSt.month, startSt.day, startSt.hour, startSt.min);
+        double end = GetMJD(endSt.year, endSt.month, endSt.day, endSt.hour, endSt.min);
+
+        // Time step
+        int timeStep;
+        TimeUnit timeUnit;
+        double timeStepData = time[1] - time[0];
+        ExtractTimeStep(timeStepData, timeStep, timeUnit);
+
+        for (const auto& variable : variables) {
+            string varName(variable.name, strnlen(variable.name, CACHE_NAME_LENGTH));
+            auto timeSeries = new TimeSeriesDistributed(MatchVariableType(varName));
+
+            // The mapping is kept alive by the time series using it.
+            std::shared_ptr<const void> values(file, data + variable.offset);
+            bool singlePrecision = header.valueSize == sizeof(float);
+
+            if (!timeSeries->SetValues(start, end, timeStep, timeUnit, ids, values, int(header.timeStepsNb), false,
+                                       singlePrecision)) {
+                wxDELETE(timeSeries);
+                return false;
+            }
+            vecTimeSeries.push_back(timeSeries);
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("Failed reading the forcing cache %s: %s"), path, e.what());
+        return false;
+    }
+
+    return true;
+}
+
 VariableType TimeSeries::MatchVariableType(const string& varName) {
     VariableType varType;
     if (StringsMatch(varName, "precipitation") || StringsMatch(varName, "p")) {
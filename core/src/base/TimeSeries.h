@@ -1,19 +1,76 @@
 #ifndef HYDROBRICKS_TIME_SERIES_H
 #define HYDROBRICKS_TIME_SERIES_H
 
+#include <memory>
+
 #include "Includes.h"
 #include "SettingsBasin.h"
 #include "TimeSeriesData.h"
 
+class Forcing;
+
 class TimeSeries : public wxObject {
   public:
     explicit TimeSeries(VariableType type);
 
     ~TimeSeries() override = default;
 
-    static bool Parse(const string& path, vector<TimeSeries*>& vecTimeSeries);
-
-    static TimeSeries* Create(const string& varName, const axd& time, const axi& ids, const axxd& data);
+    /**
+     * Read the time series of a NetCDF file.
+     *
+     * @param path The path of the file.
+     * @param vecTimeSeries The vector to which the time series are added.
+     * @param chunkSize If positive, the values are not read at once but streamed by chunks of this number of time
+     * steps during the simulation (the file must remain available).
+     * @param singlePrecision True to store the values that are read at once as float instead of double.
+     * @return True if successful, false otherwise.
+     */
+    static bool Parse(const string& path, vector<TimeSeries*>& vecTimeSeries, int chunkSize = 0,
+                      bool singlePrecision = false);
+
+    static TimeSeries* Create(const string& varName, const axd& time, const axi& ids, const axxd& data,
+                              bool singlePrecision = false);
+
+    /**
+     * Create a distributed time series referencing an existing block of values, without copying it.
+     *
+     * @param varName The name of the variable.
+     * @param time The dates of the time steps.
+     * @param ids The ids of the hydro units.
+     * @param data The values (double, or float if single precision) of [time steps x hydro units]. The owner of the
+     * memory is kept alive by the shared pointer.
+     * @param unitMajor True if the values are ordered by hydro unit and then by time step (column-major).
+     * @param singlePrecision True if the values are float instead of double.
+     * @return The time series.
+     */
+    static TimeSeries* Create(const string& varName, const axd& time, const axi& ids,
+                              std::shared_ptr<const void> data, bool unitMajor = false, bool singlePrecision = false);
+
+    /**
+     * Write distributed forcing data to a binary cache file. The file contains a header (ids, dates and variables)
+     * followed by a contiguous block of values per variable, ordered by time step and then by hydro unit. The values
+     * are stored in the native byte order.
+     *
+     * @param path The path of the file to create.
+     * @param time The dates (MJD) of the time steps.
+     * @param ids The ids of the hydro units.
+     * @param varNames The names of the variables.
+     * @param data The values of every variable as a matrix of [time steps x hydro units].
+     * @param singlePrecision Option to store the values as float instead of double.
+     * @return True if successful, false otherwise.
+     */
+    static bool WriteCache(const string& path, const axd& time, const axi& ids, const vecStr& varNames,
+                           const vecAxxd& data, bool singlePrecision = false);
+
+    /**
+     * Read the time series of a binary cache file (see WriteCache()). The file is memory-mapped and the double
+     * precision values are used in place, so that the processes using the same file share the page cache.
+     *
+     * @param path The path of the file.
+     * @param vecTimeSeries The vector to which the time series are added.
+     * @return True if successful, false otherwise.
+     */
+    static bool ParseCache(const string& path, vector<TimeSeries*>& vecTimeSeries);
 
     virtual bool SetCursorToDate(double date) = 0;
 
@@ -27,7 +84,38 @@ class TimeSeries : public wxObject {
 
     virtual double GetTotal(const SettingsBasin* basinSettings) = 0;
 
-    virtual TimeSeriesData* GetDataPointer(int unitId) = 0;
+    /**
+     * Get the value of a hydro unit at a given date (without moving the cursor).
+     *
+     * @param unitId The id of the hydro unit.
+     * @param date The date of the value.
+     * @return The value.
+     */
+    virtual double GetValueFor(int unitId, double date) = 0;
+
+    /**
+     * Connect a forcing of a hydro unit to the values of the time series.
+     *
+     * @param forcing The forcing to connect.
+     * @param unitId The id of the hydro unit.
+     */
+    virtual void AttachForcing(Forcing* forcing, int unitId) = 0;
+
+    /**
+     * Get the index of the current time step.
+     *
+     * @return The cursor position.
+     */
+    virtual int GetCursor() const = 0;
+
+    virtual void SetCursor(int cursor) = 0;
+
+    /**
+     * Create a copy of the time series sharing the same (read-only) values but having its own cursors.
+     *
+     * @return The new time series (to be deleted by the caller).
+     */
+    virtual TimeSeries* CloneSharingValues() const = 0;
 
     VariableType GetVariableType() {
         return m_type;
@@ -5,10 +5,11 @@
  */
 
 TimeSeriesData::TimeSeriesData()
-    : m_cursor(0) {}
+    : m_values(std::make_shared<vecDouble>()),
+      m_cursor(0) {}
 
 bool TimeSeriesData::SetValues(const vecDouble& values) {
-    m_values = values;
+    m_values = std::make_shared<vecDouble>(values);
     return true;
 }
 
@@ -43,23 +44,23 @@ bool TimeSeriesDataRegular::SetValues(const vecDouble& values) {
         return false;
     }
 
-    m_values = values;
+    m_values = std::make_shared<vecDouble>(values);
     return true;
 }
 
 double TimeSeriesDataRegular::GetValueFor(double date) {
     SetCursorToDate(date);
-    return m_values[m_cursor];
+    return (*m_values)[m_cursor];
 }
 
 double TimeSeriesDataRegular::GetCurrentValue() {
-    wxASSERT(m_values.size() > m_cursor);
-    return m_values[m_cursor];
+    wxASSERT(m_values->size() > m_cursor);
+    return (*m_values)[m_cursor];
 }
 
 double TimeSeriesDataRegular::GetSum() {
     double sum = 0;
-    for (const auto& value : m_values) sum += value;
+    for (const auto& value : *m_values) sum += value;
 
     return sum;
 }
@@ -94,7 +95,7 @@ bool TimeSeriesDataRegular::SetCursorToDate(double date) {
 }
 
 bool TimeSeriesDataRegular::AdvanceOneTimeStep() {
-    if (m_cursor >= m_values.size()) {
+    if (m_cursor >= m_values->size()) {
         wxLogError(_("The desired date is after the data ending date."));
         return false;
     }
@@ -111,6 +112,13 @@ double TimeSeriesDataRegular::GetEnd() {
     return m_end;
 }
 
+TimeSeriesData* TimeSeriesDataRegular::CloneSharingValues() const {
+    auto clone = new TimeSeriesDataRegular(m_start, m_end, m_timeStep, m_timeStepUnit);
+    clone->m_values = m_values;
+
+    return clone;
+}
+
 /*
  * TimeSeriesDataIrregular
  */
@@ -125,7 +133,7 @@ bool TimeSeriesDataIrregular::SetValues(const vecDouble& values) {
         return false;
     }
 
-    m_values = values;
+    m_values = std::make_shared<vecDouble>(values);
     return true;
 }
 
@@ -134,8 +142,8 @@ double TimeSeriesDataIrregular::GetValueFor(double) {
 }
 
 double TimeSeriesDataIrregular::GetCurrentValue() {
-    wxASSERT(m_values.size() > m_cursor);
-    return m_values[m_cursor];
+    wxASSERT(m_values->size() > m_cursor);
+    return (*m_values)[m_cursor];
 }
 
 double TimeSeriesDataIrregular::GetSum() {
@@ -159,3 +167,11 @@ double TimeSeriesDataIrregular::GetEnd() {
     wxASSERT(!m_dates.empty());
     return m_dates[m_dates.size() - 1];
 }
+
+TimeSeriesData* TimeSeriesDataIrregular::CloneSharingValues() const {
+    vecDouble dates = m_dates;
+    auto clone = new TimeSeriesDataIrregular(dates);
+    clone->m_values = m_values;
+
+    return clone;
+}
@@ -1,6 +1,8 @@
 #ifndef HYDROBRICKS_TIME_SERIES_DATA_H
 #define HYDROBRICKS_TIME_SERIES_DATA_H
 
+#include <memory>
+
 #include "Includes.h"
 
 class TimeSeriesData : public wxObject {
@@ -25,8 +27,24 @@ class TimeSeriesData : public wxObject {
 
     virtual double GetEnd() = 0;
 
+    /**
+     * Create a copy of the data sharing the same values, which are read-only, but having its own cursor. This allows
+     * multiple models to read the same forcing concurrently.
+     *
+     * @return The new data object (to be deleted by the caller).
+     */
+    virtual TimeSeriesData* CloneSharingValues() const = 0;
+
+    int GetCursor() const {
+        return m_cursor;
+    }
+
+    void SetCursor(int cursor) {
+        m_cursor = cursor;
+    }
+
   protected:
-    vecDouble m_values;
+    std::shared_ptr<vecDouble> m_values;
     int m_cursor;
 
   private:
@@ -54,6 +72,8 @@ class TimeSeriesDataRegular : public TimeSeriesData {
 
     double GetEnd() override;
 
+    TimeSeriesData* CloneSharingValues() const override;
+
   protected:
     double m_start;
     double m_end;
@@ -85,6 +105,8 @@ class TimeSeriesDataIrregular : public TimeSeriesData {
 
     double GetEnd() override;
 
+    TimeSeriesData* CloneSharingValues() const override;
+
   protected:
     vecDouble m_dates;
 
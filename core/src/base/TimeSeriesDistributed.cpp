@@ -1,48 +1,103 @@
 #include "TimeSeriesDistributed.h"
 
+#include "Forcing.h"
+
 TimeSeriesDistributed::TimeSeriesDistributed(VariableType type)
-    : TimeSeries(type) {}
+    : TimeSeries(type),
+      m_start(0),
+      m_end(0),
+      m_timeStep(1),
+      m_timeStepUnit(Day),
+      m_timeStepsNb(0),
+      m_values(nullptr),
+      m_singlePrecision(false),
+      m_timeStride(0),
+      m_unitStride(1),
+      m_cursor(0),
+      m_row(nullptr) {}
 
-TimeSeriesDistributed::~TimeSeriesDistributed() {
-    for (auto data : m_data) {
-        wxDELETE(data);
+bool TimeSeriesDistributed::SetValues(double start, double end, int timeStep, TimeUnit timeStepUnit,
+                                      const vecInt& unitIds, const axxd& values, bool singlePrecision) {
+    if (values.cols() != unitIds.size()) {
+        wxLogError(_("The number of hydro units of the data (%d) does not match the number of ids (%d)."),
+                   int(values.cols()), int(unitIds.size()));
+        return false;
     }
-}
 
-void TimeSeriesDistributed::AddData(TimeSeriesData* data, int unitId) {
-    wxASSERT(data);
-    m_data.push_back(data);
-    m_unitIds.push_back(unitId);
-}
+    // Transposed so that the values of a time step are contiguous.
+    auto unitsNb = int(values.cols());
+    if (singlePrecision) {
+        auto block = std::make_shared<vecFloat>(values.size());
+        for (int t = 0; t < values.rows(); ++t) {
+            for (int u = 0; u < unitsNb; ++u) {
+                (*block)[size_t(t) * unitsNb + u] = float(values(t, u));
+            }
+        }
+        return SetValues(start, end, timeStep, timeStepUnit, unitIds, std::shared_ptr<const void>(block, block->data()),
+                         int(values.rows()), false, true);
+    }
 
-bool TimeSeriesDistributed::SetCursorToDate(double date) {
-    for (auto data : m_data) {
-        if (!data->SetCursorToDate(date)) {
-            return false;
+    auto block = std::make_shared<vecDouble>(values.size());
+    for (int t = 0; t < values.rows(); ++t) {
+        for (int u = 0; u < unitsNb; ++u) {
+            (*block)[size_t(t) * unitsNb + u] = values(t, u);
         }
     }
 
-    return true;
+    return SetValues(start, end, timeStep, timeStepUnit, unitIds, std::shared_ptr<const void>(block, block->data()),
+                     int(values.rows()));
 }
 
-bool TimeSeriesDistributed::AdvanceOneTimeStep() {
-    for (auto data : m_data) {
-        if (!data->AdvanceOneTimeStep()) {
-            return false;
-        }
+bool TimeSeriesDistributed::SetValues(double start, double end, int timeStep, TimeUnit timeStepUnit,
+                                      const vecInt& unitIds, std::shared_ptr<const void> values, int timeStepsNb,
+                                      bool unitMajor, bool singlePrecision) {
+    wxASSERT(values);
+    double calcEnd = IncrementDateBy(start, timeStep * (timeStepsNb - 1), timeStepUnit);
+    if (calcEnd != end) {
+        wxLogError(_("The size of the time series data does not match the time properties."));
+        wxLogError(_("End of the data (%d) != end of the dates (%d)."), calcEnd, end);
+        return false;
     }
 
+    m_start = start;
+    m_end = end;
+    m_timeStep = timeStep;
+    m_timeStepUnit = timeStepUnit;
+    m_timeStepsNb = timeStepsNb;
+    m_unitIds = unitIds;
+    m_values = std::move(values);
+    m_singlePrecision = singlePrecision;
+    m_timeStride = unitMajor ? 1 : unitIds.size();
+    m_unitStride = unitMajor ? size_t(timeStepsNb) : 1;
+    SetCursor(0);
+
     return true;
 }
 
-double TimeSeriesDistributed::GetStart() {
-    wxASSERT(!m_data.empty());
-    return m_data[0]->GetStart();
+bool TimeSeriesDistributed::SetCursorToDate(double date) {
+    if (date < m_start) {
+        wxLogError(_("The desired date is before the data starting date."));
+        return false;
+    }
+    if (date > m_end) {
+        wxLogError(_("The desired date is after the data ending date."));
+        return false;
+    }
+
+    SetCursor(GetTimeStepIndex(date));
+
+    return true;
 }
 
-double TimeSeriesDistributed::GetEnd() {
-    wxASSERT(!m_data.empty());
-    return m_data[0]->GetEnd();
+bool TimeSeriesDistributed::AdvanceOneTimeStep() {
+    if (m_cursor >= GetTimeStepsNb()) {
+        wxLogError(_("The desired date is after the data ending date."));
+        return false;
+    }
+    m_cursor++;
+    m_row = GetValuePointer(m_cursor * m_timeStride);
+
+    return true;
 }
 
 double TimeSeriesDistributed::GetTotal(const SettingsBasin* basinSettings) {
@@ -50,22 +105,74 @@ double TimeSeriesDistributed::GetTotal(const SettingsBasin* basinSettings) {
     double areaTotal = basinSettings->GetTotalArea();
     for (int i = 0; i < basinSettings->GetHydroUnitsNb(); ++i) {
         double area = basinSettings->GetHydroUnitSettings(i).area;
-        int id = basinSettings->GetHydroUnitSettings(i).id;
-        double sumUnit = GetDataPointer(id)->GetSum();
+        int offset = GetUnitOffset(basinSettings->GetHydroUnitSettings(i).id);
+        double sumUnit = 0;
+        for (int t = 0; t < GetTimeStepsNb(); ++t) {
+            sumUnit += GetValueAt(t * m_timeStride + offset * m_unitStride);
+        }
         total += sumUnit * area / areaTotal;
     }
 
     return total;
 }
 
-TimeSeriesData* TimeSeriesDistributed::GetDataPointer(int unitId) {
-    wxASSERT(m_data.size() == m_unitIds.size());
+double TimeSeriesDistributed::GetValueFor(int unitId, double date) {
+    if (date < m_start || date > m_end) {
+        throw InvalidArgument(_("The desired date is outside of the data period."));
+    }
+
+    return GetValueAt(GetTimeStepIndex(date) * m_timeStride + GetUnitOffset(unitId) * m_unitStride);
+}
+
+void TimeSeriesDistributed::AttachForcing(Forcing* forcing, int unitId) {
+    wxASSERT(forcing);
+    forcing->AttachValues(&m_row, GetUnitOffset(unitId) * m_unitStride, m_singlePrecision);
+}
+
+void TimeSeriesDistributed::SetCursor(int cursor) {
+    m_cursor = cursor;
+    m_row = GetValuePointer(cursor * m_timeStride);
+}
+
+TimeSeries* TimeSeriesDistributed::CloneSharingValues() const {
+    auto clone = new TimeSeriesDistributed(m_type);
+    clone->m_start = m_start;
+    clone->m_end = m_end;
+    clone->m_timeStep = m_timeStep;
+    clone->m_timeStepUnit = m_timeStepUnit;
+    clone->m_timeStepsNb = m_timeStepsNb;
+    clone->m_unitIds = m_unitIds;
+    clone->m_values = m_values;
+    clone->m_singlePrecision = m_singlePrecision;
+    clone->m_timeStride = m_timeStride;
+    clone->m_unitStride = m_unitStride;
+    clone->SetCursor(m_cursor);
 
-    for (int i = 0; i < m_data.size(); ++i) {
+    return clone;
+}
+
+int TimeSeriesDistributed::GetUnitOffset(int unitId) const {
+    for (int i = 0; i < m_unitIds.size(); ++i) {
         if (m_unitIds[i] == unitId) {
-            return m_data[i];
+            return i;
         }
     }
 
     throw ShouldNotHappen();
-}
\ No newline at end of file
+}
+
+int TimeSeriesDistributed::GetTimeStepIndex(double date) const {
+    // Same lookup as TimeSeriesDataRegular::SetCursorToDate(), so that all series agree on the time step of a date.
+    double dt = date - m_start;
+
+    switch (m_timeStepUnit) {
+        case Day:
+            return int(dt);
+        case Hour:
+            return int(dt) * 24;
+        case Minute:
+            return int(dt) * 1440;
+        default:
+            throw NotImplemented();
+    }
+}
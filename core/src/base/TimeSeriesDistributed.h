@@ -1,16 +1,57 @@
 #ifndef HYDROBRICKS_TIME_SERIES_DISTRIBUTED_H
 #define HYDROBRICKS_TIME_SERIES_DISTRIBUTED_H
 
+#include <memory>
+
 #include "Includes.h"
 #include "TimeSeries.h"
 
+/**
+ * Time series with a value per hydro unit. The values are stored in a single contiguous block ordered by time step
+ * and then by hydro unit. Advancing in time moves a single row pointer, from which the forcing of every hydro unit
+ * reads its value at the offset of the unit. External blocks ordered by hydro unit can also be referenced (e.g.
+ * Fortran-ordered arrays), the row pointer then advancing by one value and the units being a time series apart.
+ * The values can be stored in single precision to halve the memory, they are then converted when read.
+ */
 class TimeSeriesDistributed : public TimeSeries {
   public:
     TimeSeriesDistributed(VariableType type);
 
-    ~TimeSeriesDistributed() override;
+    ~TimeSeriesDistributed() override = default;
+
+    /**
+     * Set the values of all hydro units.
+     *
+     * @param start The date of the first time step.
+     * @param end The date of the last time step.
+     * @param timeStep The time step.
+     * @param timeStepUnit The time step unit.
+     * @param unitIds The ids of the hydro units.
+     * @param values The values as a matrix of [time steps x hydro units].
+     * @param singlePrecision True to store the values as float instead of double.
+     * @return True if successful, false otherwise.
+     */
+    bool SetValues(double start, double end, int timeStep, TimeUnit timeStepUnit, const vecInt& unitIds,
+                   const axxd& values, bool singlePrecision = false);
 
-    void AddData(TimeSeriesData* data, int unitId);
+    /**
+     * Use an existing block of values, without copying it (e.g. a memory-mapped file).
+     *
+     * @param start The date of the first time step.
+     * @param end The date of the last time step.
+     * @param timeStep The time step.
+     * @param timeStepUnit The time step unit.
+     * @param unitIds The ids of the hydro units.
+     * @param values The values (double, or float if single precision) ordered by time step and then by hydro unit.
+     * The owner of the memory is kept alive by the shared pointer.
+     * @param timeStepsNb The number of time steps of the block.
+     * @param unitMajor True if the values are ordered by hydro unit and then by time step instead.
+     * @param singlePrecision True if the values are float instead of double.
+     * @return True if successful, false otherwise.
+     */
+    bool SetValues(double start, double end, int timeStep, TimeUnit timeStepUnit, const vecInt& unitIds,
+                   std::shared_ptr<const void> values, int timeStepsNb, bool unitMajor = false,
+                   bool singlePrecision = false);
 
     bool SetCursorToDate(double date) override;
 
@@ -20,17 +61,71 @@ class TimeSeriesDistributed : public TimeSeries {
         return true;
     }
 
-    double GetStart() override;
+    double GetStart() override {
+        return m_start;
+    }
 
-    double GetEnd() override;
+    double GetEnd() override {
+        return m_end;
+    }
 
     double GetTotal(const SettingsBasin* basinSettings) override;
 
-    TimeSeriesData* GetDataPointer(int unitId) override;
+    double GetValueFor(int unitId, double date) override;
+
+    void AttachForcing(Forcing* forcing, int unitId) override;
+
+    int GetCursor() const override {
+        return m_cursor;
+    }
+
+    void SetCursor(int cursor) override;
+
+    TimeSeries* CloneSharingValues() const override;
+
+    int GetTimeStepsNb() const {
+        return m_timeStepsNb;
+    }
+
+    bool IsSinglePrecision() const {
+        return m_singlePrecision;
+    }
 
   protected:
+    double m_start;
+    double m_end;
+    int m_timeStep;
+    TimeUnit m_timeStepUnit;
+    int m_timeStepsNb;
     vecInt m_unitIds;
-    vector<TimeSeriesData*> m_data;
+    std::shared_ptr<const void> m_values;  // [time steps x hydro units], row-major unless unit-major strides.
+    bool m_singlePrecision;  // Values stored as float instead of double.
+    size_t m_timeStride;  // Distance between the values of two successive time steps.
+    size_t m_unitStride;  // Distance between the values of two successive hydro units.
+    int m_cursor;
+    const void* m_row;  // Values of the current time step.
+
+    const void* GetValuePointer(size_t index) const {
+        if (m_singlePrecision) {
+            return static_cast<const float*>(m_values.get()) + index;
+        }
+        return static_cast<const double*>(m_values.get()) + index;
+    }
+
+    double GetValueAt(size_t index) const {
+        if (m_singlePrecision) {
+            return static_cast<const float*>(m_values.get())[index];
+        }
+        return static_cast<const double*>(m_values.get())[index];
+    }
+
+    int GetUnitOffset(int unitId) const;
+
+    /**
+     * Get the index of the time step of a date. As for the regular data of the uniform series, the date is truncated
+     * to the start of its day.
+     */
+    int GetTimeStepIndex(double date) const;
 
   private:
 };
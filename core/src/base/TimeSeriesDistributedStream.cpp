@@ -0,0 +1,230 @@
+#include "TimeSeriesDistributedStream.h"
+
+#include <mutex>
+
+// The NetCDF library is not thread-safe: the reads of all streams are serialized.
+static std::mutex s_netcdfMutex;
+
+TimeSeriesDistributedStream::TimeSeriesDistributedStream(VariableType type)
+    : TimeSeriesDistributed(type),
+      m_varId(-1),
+      m_timeFirst(true),
+      m_chunkSize(0),
+      m_chunkStart(0),
+      m_chunkEnd(0),
+      m_chunk(std::make_shared<vecDouble>()),
+      m_nextChunk(std::make_shared<vecDouble>()),
+      m_nextChunkStart(-1) {}
+
+TimeSeriesDistributedStream::~TimeSeriesDistributedStream() {
+    if (m_prefetch.valid()) {
+        m_prefetch.wait();
+    }
+}
+
+bool TimeSeriesDistributedStream::Open(const string& path, const string& varName, int chunkSize, double start,
+                                       double end, int timeStep, TimeUnit timeStepUnit, const vecInt& unitIds) {
+    if (chunkSize <= 0) {
+        wxLogError(_("The chunk size must be positive (%d given)."), chunkSize);
+        return false;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(s_netcdfMutex);
+        if (!m_file.OpenReadOnly(path)) {
+            return false;
+        }
+        m_varId = m_file.GetVarId(varName);
+        m_timeFirst = m_file.GetVarDimIds(m_varId, 2)[0] == m_file.GetDimId("time");
+        m_timeStepsNb = m_file.GetDimLen("time");
+        if (m_file.GetDimLen("hydro_units") != unitIds.size()) {
+            wxLogError(_("The number of hydro units of the variable %s does not match the number of ids."), varName);
+            return false;
+        }
+    } catch (const std::exception& e) {
+        wxLogError(_("Failed opening the variable %s of %s: %s"), varName, path, e.what());
+        return false;
+    }
+
+    double calcEnd = IncrementDateBy(start, timeStep * (m_timeStepsNb - 1), timeStepUnit);
+    if (calcEnd != end) {
+        wxLogError(_("The size of the time series data does not match the time properties."));
+        return false;
+    }
+
+    m_path = path;
+    m_varName = varName;
+    m_chunkSize = chunkSize;
+    m_start = start;
+    m_end = end;
+    m_timeStep = timeStep;
+    m_timeStepUnit = timeStepUnit;
+    m_unitIds = unitIds;
+    m_timeStride = unitIds.size();
+
+    try {
+        SetCursor(0);
+    } catch (const std::exception& e) {
+        wxLogError(_("Failed reading the variable %s of %s: %s"), varName, path, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool TimeSeriesDistributedStream::AdvanceOneTimeStep() {
+    if (m_cursor >= m_timeStepsNb) {
+        wxLogError(_("The desired date is after the data ending date."));
+        return false;
+    }
+    m_cursor++;
+
+    if (m_cursor < m_chunkEnd || m_cursor >= m_timeStepsNb) {
+        m_row = static_cast<const double*>(m_row) + m_timeStride;
+        return true;
+    }
+
+    // End of the chunk: switch to the next one.
+    try {
+        SetCursor(m_cursor);
+    } catch (const std::exception& e) {
+        wxLogError(_("Failed reading the variable %s of %s: %s"), m_varName, m_path, e.what());
+        return false;
+    }
+
+    return true;
+}
+
+double TimeSeriesDistributedStream::GetTotal(const SettingsBasin* basinSettings) {
+    WaitForPrefetch();
+
+    double areaTotal = basinSettings->GetTotalArea();
+    auto unitsNb = int(m_unitIds.size());
+    vecInt offsets;
+    vecDouble weights;
+    for (int i = 0; i < basinSettings->GetHydroUnitsNb(); ++i) {
+        offsets.push_back(GetUnitOffset(basinSettings->GetHydroUnitSettings(i).id));
+        weights.push_back(basinSettings->GetHydroUnitSettings(i).area / areaTotal);
+    }
+
+    // Read the whole series chunk by chunk, independently of the current chunk.
+    double total = 0;
+    vecDouble values;
+    for (int chunkStart = 0; chunkStart < m_timeStepsNb; chunkStart += m_chunkSize) {
+        ReadChunk(chunkStart, values);
+        for (int t = 0; t < GetChunkLength(chunkStart); ++t) {
+            for (int i = 0; i < offsets.size(); ++i) {
+                total += values[size_t(t) * unitsNb + offsets[i]] * weights[i];
+            }
+        }
+    }
+
+    return total;
+}
+
+double TimeSeriesDistributedStream::GetValueFor(int unitId, double date) {
+    WaitForPrefetch();
+
+    if (date < m_start || date > m_end) {
+        throw InvalidArgument(_("The desired date is outside of the data period."));
+    }
+
+    auto timeIndex = size_t(GetTimeStepIndex(date));
+    auto unitIndex = size_t(GetUnitOffset(unitId));
+    size_t start[2] = {timeIndex, unitIndex};
+    if (!m_timeFirst) {
+        std::swap(start[0], start[1]);
+    }
+    size_t count[2] = {1, 1};
+
+    double value;
+    std::lock_guard<std::mutex> lock(s_netcdfMutex);
+    m_file.GetVarDouble2DBlock(m_varId, start, count, &value);
+
+    return value;
+}
+
+void TimeSeriesDistributedStream::SetCursor(int cursor) {
+    // The position after the last time step is allowed, in the last chunk.
+    int timeStep = wxMin(cursor, m_timeStepsNb - 1);
+
+    if (timeStep < m_chunkStart || timeStep >= m_chunkEnd) {
+        WaitForPrefetch();
+        if (m_nextChunkStart >= 0 && timeStep >= m_nextChunkStart &&
+            timeStep < m_nextChunkStart + GetChunkLength(m_nextChunkStart)) {
+            std::swap(m_chunk, m_nextChunk);
+            m_chunkStart = m_nextChunkStart;
+        } else {
+            ReadChunk(timeStep, *m_chunk);
+            m_chunkStart = timeStep;
+        }
+        m_chunkEnd = m_chunkStart + GetChunkLength(m_chunkStart);
+        m_values = std::shared_ptr<const void>(m_chunk, m_chunk->data());
+        m_nextChunkStart = -1;
+
+        if (m_chunkEnd < m_timeStepsNb) {
+            StartPrefetch(m_chunkEnd);
+        }
+    }
+
+    m_cursor = cursor;
+    m_row = m_chunk->data() + size_t(cursor - m_chunkStart) * m_timeStride;
+}
+
+TimeSeries* TimeSeriesDistributedStream::CloneSharingValues() const {
+    // The chunks cannot be shared as the cursors differ: the clone reads the file on its own.
+    auto clone = new TimeSeriesDistributedStream(m_type);
+    if (!clone->Open(m_path, m_varName, m_chunkSize, m_start, m_end, m_timeStep, m_timeStepUnit, m_unitIds)) {
+        wxDELETE(clone);
+        throw InvalidArgument(_("The streamed time series could not be cloned."));
+    }
+    clone->SetCursor(m_cursor);
+
+    return clone;
+}
+
+int TimeSeriesDistributedStream::GetChunkLength(int chunkStart) const {
+    return wxMin(m_chunkSize, m_timeStepsNb - chunkStart);
+}
+
+void TimeSeriesDistributedStream::ReadChunk(int chunkStart, vecDouble& values) {
+    auto length = size_t(GetChunkLength(chunkStart));
+    size_t unitsNb = m_unitIds.size();
+    values.resize(length * unitsNb);
+
+    std::lock_guard<std::mutex> lock(s_netcdfMutex);
+    if (m_timeFirst) {
+        size_t start[2] = {size_t(chunkStart), 0};
+        size_t count[2] = {length, unitsNb};
+        m_file.GetVarDouble2DBlock(m_varId, start, count, values.data());
+    } else {
+        // Stored by hydro unit: transposed to be contiguous by time step.
+        size_t start[2] = {0, size_t(chunkStart)};
+        size_t count[2] = {unitsNb, length};
+        vecDouble unitMajor(length * unitsNb);
+        m_file.GetVarDouble2DBlock(m_varId, start, count, unitMajor.data());
+        for (size_t u = 0; u < unitsNb; ++u) {
+            for (size_t t = 0; t < length; ++t) {
+                values[t * unitsNb + u] = unitMajor[u * length + t];
+            }
+        }
+    }
+}
+
+void TimeSeriesDistributedStream::WaitForPrefetch() {
+    if (!m_prefetch.valid()) {
+        return;
+    }
+    try {
+        m_prefetch.get();
+    } catch (...) {
+        m_nextChunkStart = -1;
+        throw;
+    }
+}
+
+void TimeSeriesDistributedStream::StartPrefetch(int chunkStart) {
+    m_nextChunkStart = chunkStart;
+    std::shared_ptr<vecDouble> values = m_nextChunk;
+    m_prefetch = std::async(std::launch::async, [this, chunkStart, values]() { ReadChunk(chunkStart, *values); });
+}
@@ -0,0 +1,76 @@
+#ifndef HYDROBRICKS_TIME_SERIES_DISTRIBUTED_STREAM_H
+#define HYDROBRICKS_TIME_SERIES_DISTRIBUTED_STREAM_H
+
+#include <future>
+
+#include "FileNetcdf.h"
+#include "Includes.h"
+#include "TimeSeriesDistributed.h"
+
+/**
+ * Distributed time series read from a NetCDF file by chunks of time steps. Only the current chunk is in memory,
+ * while the next one is read on a background thread. The memory is thus bounded by twice the chunk size, and the
+ * reading overlaps with the computation. The NetCDF library not being thread-safe, the reads of the streams are
+ * serialized and no other NetCDF file should be accessed during the simulation.
+ */
+class TimeSeriesDistributedStream : public TimeSeriesDistributed {
+  public:
+    TimeSeriesDistributedStream(VariableType type);
+
+    ~TimeSeriesDistributedStream() override;
+
+    /**
+     * Open the variable in the file and read the first chunk.
+     *
+     * @param path The path of the NetCDF file.
+     * @param varName The name of the variable.
+     * @param chunkSize The number of time steps per chunk.
+     * @param start The date of the first time step.
+     * @param end The date of the last time step.
+     * @param timeStep The time step.
+     * @param timeStepUnit The time step unit.
+     * @param unitIds The ids of the hydro units.
+     * @return True if successful, false otherwise.
+     */
+    bool Open(const string& path, const string& varName, int chunkSize, double start, double end, int timeStep,
+              TimeUnit timeStepUnit, const vecInt& unitIds);
+
+    bool AdvanceOneTimeStep() override;
+
+    double GetTotal(const SettingsBasin* basinSettings) override;
+
+    double GetValueFor(int unitId, double date) override;
+
+    void SetCursor(int cursor) override;
+
+    TimeSeries* CloneSharingValues() const override;
+
+    int GetChunkSize() const {
+        return m_chunkSize;
+    }
+
+  protected:
+    string m_path;
+    string m_varName;
+    FileNetcdf m_file;
+    int m_varId;
+    bool m_timeFirst;
+    int m_chunkSize;
+    int m_chunkStart;
+    int m_chunkEnd;
+    std::shared_ptr<vecDouble> m_chunk;
+    std::shared_ptr<vecDouble> m_nextChunk;
+    int m_nextChunkStart;
+    std::future<void> m_prefetch;
+
+  private:
+    int GetChunkLength(int chunkStart) const;
+
+    void ReadChunk(int chunkStart, vecDouble& values);
+
+    void WaitForPrefetch();
+
+    void StartPrefetch(int chunkStart);
+};
+
+#endif  // HYDROBRICKS_TIME_SERIES_DISTRIBUTED_STREAM_H
@@ -1,5 +1,7 @@
 #include "TimeSeriesUniform.h"
 
+#include "Forcing.h"
+
 TimeSeriesUniform::TimeSeriesUniform(VariableType type)
     : TimeSeries(type),
       m_data(nullptr) {}
@@ -40,7 +42,21 @@ double TimeSeriesUniform::GetTotal(const SettingsBasin*) {
     throw NotImplemented();
 }
 
-TimeSeriesData* TimeSeriesUniform::GetDataPointer(int) {
+double TimeSeriesUniform::GetValueFor(int, double date) {
     wxASSERT(m_data);
-    return m_data;
-}
\ No newline at end of file
+    return m_data->GetValueFor(date);
+}
+
+void TimeSeriesUniform::AttachForcing(Forcing* forcing, int) {
+    wxASSERT(forcing);
+    wxASSERT(m_data);
+    forcing->AttachTimeSeriesData(m_data);
+}
+
+TimeSeries* TimeSeriesUniform::CloneSharingValues() const {
+    wxASSERT(m_data);
+    auto clone = new TimeSeriesUniform(m_type);
+    clone->SetData(m_data->CloneSharingValues());
+
+    return clone;
+}
@@ -29,7 +29,21 @@ class TimeSeriesUniform : public TimeSeries {
 
     double GetTotal(const SettingsBasin* basinSettings) override;
 
-    TimeSeriesData* GetDataPointer(int unitId) override;
+    double GetValueFor(int unitId, double date) override;
+
+    void AttachForcing(Forcing* forcing, int unitId) override;
+
+    int GetCursor() const override {
+        wxASSERT(m_data);
+        return m_data->GetCursor();
+    }
+
+    void SetCursor(int cursor) override {
+        wxASSERT(m_data);
+        m_data->SetCursor(cursor);
+    }
+
+    TimeSeries* CloneSharingValues() const override;
 
   protected:
     TimeSeriesData* m_data;
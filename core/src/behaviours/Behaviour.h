@@ -32,6 +32,14 @@ class Behaviour : public wxObject {
         m_cursor++;
     }
 
+    int GetCursor() const {
+        return m_cursor;
+    }
+
+    void SetCursor(int cursor) {
+        m_cursor = cursor;
+    }
+
   protected:
     BehavioursManager* m_manager;
     int m_cursor;
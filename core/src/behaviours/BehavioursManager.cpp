@@ -69,12 +69,19 @@ void BehavioursManager::DateUpdate(double date) {
     }
     wxASSERT(m_dates.size() == m_behaviourIndices.size());
 
+    bool applied = false;
     while (m_dates.size() > m_cursorManager && m_dates[m_cursorManager] <= date) {
         if (!m_behaviours[m_behaviourIndices[m_cursorManager]]->Apply(date)) {
             throw InvalidArgument(_("Application of a behaviour failed."));
         }
         m_behaviours[m_behaviourIndices[m_cursorManager]]->IncrementCursor();
         m_cursorManager++;
+        applied = true;
+    }
+
+    // Land cover changes can activate or deactivate bricks.
+    if (applied && m_model) {
+        m_model->GetProcessor()->UpdateActiveBricks();
     }
 }
 
@@ -35,6 +35,19 @@ class BehavioursManager : public wxObject {
         return m_dates;
     }
 
+    Behaviour* GetBehaviour(int index) {
+        wxASSERT(m_behaviours.size() > index);
+        return m_behaviours[index];
+    }
+
+    int GetCursor() const {
+        return m_cursorManager;
+    }
+
+    void SetCursor(int cursor) {
+        m_cursorManager = cursor;
+    }
+
   protected:
     bool m_active;
     ModelHydro* m_model;
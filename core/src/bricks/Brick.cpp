@@ -10,6 +10,9 @@
 
 Brick::Brick()
     : m_needsSolver(true),
+      m_analyticalIntegration(false),
+      m_quiescent(false),
+      m_subStepsNb(1),
       m_container(nullptr) {
     m_container = new WaterContainer(this);
 }
@@ -49,6 +52,15 @@ void Brick::SaveAsInitialState() {
     m_container->SaveAsInitialState();
 }
 
+void Brick::CopyStateFrom(Brick* other) {
+    vector<WaterContainer*> containers = GetWaterContainers();
+    vector<WaterContainer*> otherContainers = other->GetWaterContainers();
+    wxASSERT(containers.size() == otherContainers.size());
+    for (int i = 0; i < containers.size(); ++i) {
+        containers[i]->CopyStateFrom(otherContainers[i]);
+    }
+}
+
 bool Brick::IsOk() {
     if (m_processes.empty()) {
         wxLogError(_("The brick %s has no process attached"), m_name);
@@ -66,6 +78,13 @@ void Brick::SetParameters(const BrickSettings& brickSettings) {
     if (HasParameter(brickSettings, "capacity")) {
         m_container->SetMaximumCapacity(GetParameterValuePointer(brickSettings, "capacity"));
     }
+    if (HasParameter(brickSettings, "sub_steps")) {
+        m_subStepsNb = wxMax(1, int(std::lround(*GetParameterValuePointer(brickSettings, "sub_steps"))));
+        if (m_subStepsNb > 1 && (m_container->HasMaximumCapacity() || GetWaterContainers().size() != 1)) {
+            throw ConceptionIssue(
+                _("Sub steps can only be used for bricks with a single water container without maximum capacity."));
+        }
+    }
 }
 
 void Brick::AttachFluxIn(Flux* flux) {
@@ -118,24 +137,41 @@ WaterContainer* Brick::GetWaterContainer() {
     return m_container;
 }
 
-vecDoublePt Brick::GetDynamicContentChanges() {
-    return m_container->GetDynamicContentChanges();
+vector<WaterContainer*> Brick::GetWaterContainers() {
+    return vector<WaterContainer*>{m_container};
 }
 
-vecDoublePt Brick::GetStateVariableChangesFromProcesses() {
-    vecDoublePt values;
-    for (auto const& process : m_processes) {
-        vecDoublePt processValues = process->GetStateVariables();
-
-        if (processValues.empty()) {
-            continue;
+bool Brick::HasNoContentNorOutgoingFlux() {
+    if (!HasQuiescentContainers()) {
+        return false;
+    }
+    for (auto process : m_processes) {
+        for (auto flux : process->GetOutputFluxes()) {
+            if (*flux->GetAmountPointer() != 0) {
+                return false;
+            }
         }
-        for (auto const& value : processValues) {
-            values.push_back(value);
+    }
+
+    return true;
+}
+
+bool Brick::HasQuiescentContainers() {
+    return m_container->IsQuiescent();
+}
+
+bool Brick::HasOnlyLinearOutflows() {
+    if (m_processes.empty() || GetWaterContainers().size() != 1 || m_container->HasMaximumCapacity() ||
+        m_container->IsInfiniteStorage()) {
+        return false;
+    }
+    for (auto process : m_processes) {
+        if (!process->IsLinearOutflow() || process->GetConnectionsNb() != 1) {
+            return false;
         }
     }
 
-    return values;
+    return true;
 }
 
 int Brick::GetProcessesConnectionsNb() {
@@ -62,6 +62,13 @@ class Brick : public wxObject {
 
     virtual void SaveAsInitialState();
 
+    /**
+     * Copy the state of the water containers of an identical brick (e.g. in a model replica).
+     *
+     * @param other The brick to copy the state from.
+     */
+    void CopyStateFrom(Brick* other);
+
     /**
      * Check that everything is correctly defined.
      *
@@ -78,6 +85,61 @@ class Brick : public wxObject {
         return m_needsSolver;
     }
 
+    /**
+     * Check if the brick can be integrated analytically: a single water container without maximum capacity that
+     * is only emptied by linear outflows.
+     *
+     * @return True if the brick can be integrated analytically.
+     */
+    bool HasOnlyLinearOutflows();
+
+    void SetAnalyticalIntegration(bool value) {
+        m_analyticalIntegration = value;
+    }
+
+    bool UsesAnalyticalIntegration() const {
+        return m_analyticalIntegration;
+    }
+
+    /**
+     * Get the number of sub steps used to integrate the brick within a time step (defined by the "sub_steps"
+     * parameter). The bricks with more than one sub step form the fast partition of the model: they are sub-cycled
+     * by the solver while the other bricks are integrated once per time step.
+     *
+     * @return The number of sub steps.
+     */
+    int GetSubStepsNb() const {
+        return m_subStepsNb;
+    }
+
+    /**
+     * Define if the brick is quiescent during the current time step: it is empty and has no incoming water, so
+     * that its processing can be skipped.
+     *
+     * @param value True if the brick is quiescent.
+     */
+    void SetQuiescent(bool value) {
+        m_quiescent = value;
+    }
+
+    bool IsQuiescent() const {
+        return m_quiescent;
+    }
+
+    /**
+     * Check if the containers of the brick are quiescent and its outgoing fluxes are null.
+     *
+     * @return True if nothing can come out of the brick without new inputs.
+     */
+    bool HasNoContentNorOutgoingFlux();
+
+    /**
+     * Check if all the water containers of the brick are quiescent.
+     *
+     * @return True if the containers are empty and have no pending change.
+     */
+    virtual bool HasQuiescentContainers();
+
     virtual bool CanHaveAreaFraction() {
         return false;
     }
@@ -121,13 +183,11 @@ class Brick : public wxObject {
     }
 
     /**
-     * Get pointers to the state variables.
+     * Get all the water containers of the brick (their dynamic content changes are the state variables).
      *
-     * @return vector of pointers to the state variables.
+     * @return vector of the water containers.
      */
-    virtual vecDoublePt GetDynamicContentChanges();
-
-    vecDoublePt GetStateVariableChangesFromProcesses();
+    virtual vector<WaterContainer*> GetWaterContainers();
 
     int GetProcessesConnectionsNb();
 
@@ -138,6 +198,9 @@ class Brick : public wxObject {
   protected:
     string m_name;
     bool m_needsSolver;
+    bool m_analyticalIntegration;
+    bool m_quiescent;
+    int m_subStepsNb;
     WaterContainer* m_container;
     vector<Process*> m_processes;
 
@@ -70,16 +70,12 @@ void Glacier::ApplyConstraints(double timeStep) {
     m_container->ApplyConstraints(timeStep);
 }
 
-vecDoublePt Glacier::GetDynamicContentChanges() {
-    vecDoublePt vars;
-    for (auto const& var : m_container->GetDynamicContentChanges()) {
-        vars.push_back(var);
-    }
-    for (auto const& var : m_ice->GetDynamicContentChanges()) {
-        vars.push_back(var);
-    }
+bool Glacier::HasQuiescentContainers() {
+    return m_ice->IsQuiescent() && m_container->IsQuiescent();
+}
 
-    return vars;
+vector<WaterContainer*> Glacier::GetWaterContainers() {
+    return vector<WaterContainer*>{m_container, m_ice};
 }
 
 double* Glacier::GetValuePointer(const string& name) {
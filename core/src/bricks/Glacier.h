@@ -35,7 +35,9 @@ class Glacier : public LandCover {
 
     void ApplyConstraints(double timeStep) override;
 
-    vecDoublePt GetDynamicContentChanges() override;
+    bool HasQuiescentContainers() override;
+
+    vector<WaterContainer*> GetWaterContainers() override;
 
     double* GetValuePointer(const string& name) override;
 
@@ -57,16 +57,12 @@ void Snowpack::ApplyConstraints(double timeStep) {
     m_container->ApplyConstraints(timeStep);
 }
 
-vecDoublePt Snowpack::GetDynamicContentChanges() {
-    vecDoublePt vars;
-    for (auto const& var : m_container->GetDynamicContentChanges()) {
-        vars.push_back(var);
-    }
-    for (auto const& var : m_snow->GetDynamicContentChanges()) {
-        vars.push_back(var);
-    }
+bool Snowpack::HasQuiescentContainers() {
+    return m_snow->IsQuiescent() && m_container->IsQuiescent();
+}
 
-    return vars;
+vector<WaterContainer*> Snowpack::GetWaterContainers() {
+    return vector<WaterContainer*>{m_container, m_snow};
 }
 
 double* Snowpack::GetValuePointer(const string& name) {
@@ -34,7 +34,9 @@ class Snowpack : public SurfaceComponent {
 
     void ApplyConstraints(double timeStep) override;
 
-    vecDoublePt GetDynamicContentChanges() override;
+    bool HasQuiescentContainers() override;
+
+    vector<WaterContainer*> GetWaterContainers() override;
 
     double* GetValuePointer(const string& name) override;
 
@@ -0,0 +1,48 @@
+#ifndef HYDROBRICKS_CONTAINER_CONSTRAINT_H
+#define HYDROBRICKS_CONTAINER_CONSTRAINT_H
+
+#include "Includes.h"
+
+class Forcing;
+class IceContainer;
+class WaterContainer;
+
+/**
+ * Incoming amount that does not depend on the solver (instantaneous, forcing or static flux). Either the amount
+ * pointer or the forcing is defined.
+ */
+struct ConstraintStaticInput {
+    const double* amount = nullptr;
+    Forcing* forcing = nullptr;
+};
+
+/**
+ * Constraints of a water container resolved once against the change rates vector of the solver. The rows of the
+ * outgoing and incoming rates are stored in the flat rows vector of the table and the static inputs in its own flat
+ * vector, both referenced by [start, end[ ranges.
+ */
+struct ContainerConstraint {
+    WaterContainer* container = nullptr;
+    IceContainer* ice = nullptr;
+    const float* capacity = nullptr;
+    int outputsStart = 0;
+    int outputsEnd = 0;
+    int inputsStart = 0;
+    int inputsEnd = 0;
+    int staticInputsStart = 0;
+    int staticInputsEnd = 0;
+    int overflowRow = -1;
+};
+
+/**
+ * Flat table of the constraints of all the containers handled by the solver, sorted by brick. The constraints of
+ * the brick i are in [bricksStart[i], bricksStart[i + 1][.
+ */
+struct ConstraintTable {
+    vector<ContainerConstraint> constraints;
+    vecInt rows;
+    vector<ConstraintStaticInput> staticInputs;
+    vecInt bricksStart;
+};
+
+#endif  // HYDROBRICKS_CONTAINER_CONSTRAINT_H
@@ -8,25 +8,25 @@ IceContainer::IceContainer(Brick* brick)
       m_relatedSnowpack(nullptr) {}
 
 void IceContainer::ApplyConstraints(double timeStep) {
-    if (m_noMeltWhenSnowCover) {
-        if (m_relatedSnowpack == nullptr) {
-            throw ConceptionIssue(_("No snowpack provided for the glacier melt limitation."));
-        }
-        if (m_relatedSnowpack->HasSnow()) {
-            SetOutgoingRatesToZero();
-        }
+    if (IsMeltBlocked()) {
+        SetOutgoingRatesToZero();
     }
     WaterContainer::ApplyConstraints(timeStep);
 }
 
 bool IceContainer::ContentAccessible() const {
-    if (m_noMeltWhenSnowCover) {
-        if (m_relatedSnowpack == nullptr) {
-            throw ConceptionIssue(_("No snowpack provided for the glacier melt limitation."));
-        }
-        if (m_relatedSnowpack->HasSnow()) {
-            return false;
-        }
+    if (IsMeltBlocked()) {
+        return false;
     }
     return WaterContainer::ContentAccessible();
+}
+
+bool IceContainer::IsMeltBlocked() const {
+    if (!m_noMeltWhenSnowCover) {
+        return false;
+    }
+    if (m_relatedSnowpack == nullptr) {
+        throw ConceptionIssue(_("No snowpack provided for the glacier melt limitation."));
+    }
+    return m_relatedSnowpack->HasSnow();
 }
\ No newline at end of file
@@ -25,6 +25,13 @@ class IceContainer : public WaterContainer {
 
     bool ContentAccessible() const override;
 
+    /**
+     * Check if the melt is blocked by the snow cover of the related snowpack.
+     *
+     * @return True if the outgoing rates must be nulled.
+     */
+    bool IsMeltBlocked() const;
+
   protected:
   private:
     bool m_noMeltWhenSnowCover;
@@ -5,7 +5,8 @@
 
 WaterContainer::WaterContainer(Brick* brick)
     : m_content(0),
-      m_contentChangeDynamic(0),
+      m_contentChangeDynamic(&m_contentChangeDynamicLocal),
+      m_contentChangeDynamicLocal(0),
       m_contentChangeStatic(0),
       m_initialState(0),
       m_capacity(nullptr),
@@ -30,12 +31,12 @@ bool WaterContainer::IsOk() {
 
 void WaterContainer::SubtractAmountFromDynamicContentChange(double change) {
     if (m_infiniteStorage) return;
-    m_contentChangeDynamic -= change;
+    *m_contentChangeDynamic -= change;
 }
 
 void WaterContainer::AddAmountToDynamicContentChange(double change) {
     if (m_infiniteStorage) return;
-    m_contentChangeDynamic += change;
+    *m_contentChangeDynamic += change;
 }
 
 void WaterContainer::AddAmountToStaticContentChange(double change) {
@@ -47,7 +48,6 @@ void WaterContainer::ApplyConstraints(double timeStep) {
     if (m_infiniteStorage) return;
 
     // Get outgoing change rates
-    vecDoublePt outgoingRates;
     double outputs = 0;
     for (auto process : m_parent->GetProcesses()) {
         if (process->GetWaterContainer() != this) {
@@ -59,19 +59,15 @@ void WaterContainer::ApplyConstraints(double timeStep) {
                 // For example when the originating brick has an area = 0.
                 continue;
             }
-            wxASSERT(changeRate);
             wxASSERT(*changeRate < 1000);
             if (*changeRate < 0) {
                 *changeRate = 0;
             }
-            wxASSERT(*changeRate > -EPSILON_D);
-            outgoingRates.push_back(changeRate);
             outputs += *changeRate;
         }
     }
 
     // Get incoming change rates
-    vecDoublePt incomingRates;
     double inputs = 0;
     double inputsStatic = 0;
     for (auto& input : m_inputs) {
@@ -88,13 +84,10 @@ void WaterContainer::ApplyConstraints(double timeStep) {
             // For example when the originating brick has an area = 0.
             continue;
         }
-        wxASSERT(changeRate);
         wxASSERT(*changeRate < 1000);
         if (*changeRate < 0) {
             *changeRate = 0;
         }
-        wxASSERT(*changeRate > -EPSILON_D);
-        incomingRates.push_back(changeRate);
         inputs += *changeRate;
     }
 
@@ -105,19 +98,26 @@ void WaterContainer::ApplyConstraints(double timeStep) {
     if (change < 0 && content + inputsStatic + change * timeStep < 0) {
         double diff = (content + inputsStatic + change * timeStep) / timeStep;
         // Limit the different rates proportionally
-        for (auto rate : outgoingRates) {
-            wxASSERT(rate != nullptr);
-            wxASSERT(*rate < 1000);
-            wxASSERT(*rate > -EPSILON_D);
-            wxASSERT(*rate >= 0);
-            if (*rate <= EPSILON_D) {
+        for (auto process : m_parent->GetProcesses()) {
+            if (process->GetWaterContainer() != this) {
                 continue;
             }
-            if (std::abs(diff - change) < PRECISION) {
-                *rate = 0;
-                continue;
+            for (auto flux : process->GetOutputFluxes()) {
+                double* rate = flux->GetChangeRatePointer();
+                if (rate == nullptr) {
+                    continue;
+                }
+                wxASSERT(*rate < 1000);
+                wxASSERT(*rate >= 0);
+                if (*rate <= EPSILON_D) {
+                    continue;
+                }
+                if (std::abs(diff - change) < PRECISION) {
+                    *rate = 0;
+                    continue;
+                }
+                *rate += diff * std::abs((*rate) / outputs);
             }
-            *rate += diff * std::abs((*rate) / outputs);
         }
     }
 
@@ -139,8 +139,14 @@ void WaterContainer::ApplyConstraints(double timeStep) {
                     _("Forcing is coming directly into a brick with limited capacity and no overflow."));
             }
             // Limit the different rates proportionally
-            for (auto rate : incomingRates) {
-                wxASSERT(rate != nullptr);
+            for (auto& input : m_inputs) {
+                if (input->IsInstantaneous() || input->IsForcing() || input->IsStatic()) {
+                    continue;
+                }
+                double* rate = input->GetChangeRatePointer();
+                if (rate == nullptr) {
+                    continue;
+                }
                 wxASSERT(*rate < 1000);
                 wxASSERT(*rate > -EPSILON_D);
                 if (*rate == 0.0) {
@@ -171,15 +177,15 @@ void WaterContainer::SetOutgoingRatesToZero() {
 
 void WaterContainer::Finalize() {
     if (m_infiniteStorage) return;
-    m_content += m_contentChangeDynamic + m_contentChangeStatic;
-    m_contentChangeDynamic = 0;
+    m_content += *m_contentChangeDynamic + m_contentChangeStatic;
+    *m_contentChangeDynamic = 0;
     m_contentChangeStatic = 0;
     wxASSERT(m_content >= -PRECISION);
 }
 
 void WaterContainer::Reset() {
     m_content = m_initialState;
-    m_contentChangeDynamic = 0;
+    *m_contentChangeDynamic = 0;
     m_contentChangeStatic = 0;
 }
 
@@ -200,8 +206,15 @@ bool WaterContainer::ContentAccessible() const {
     return GetContentWithChanges() > 0;
 }
 
-vecDoublePt WaterContainer::GetDynamicContentChanges() {
-    return vecDoublePt{&m_contentChangeDynamic};
+void WaterContainer::LinkDynamicContentChange(double* value) {
+    wxASSERT(value);
+    *value = *m_contentChangeDynamic;
+    m_contentChangeDynamic = value;
+}
+
+void WaterContainer::UnlinkDynamicContentChange() {
+    m_contentChangeDynamicLocal = *m_contentChangeDynamic;
+    m_contentChangeDynamic = &m_contentChangeDynamicLocal;
 }
 
 double WaterContainer::GetTargetFillingRatio() {
@@ -28,7 +28,17 @@ class WaterContainer : public wxObject {
 
     void SaveAsInitialState();
 
-    vecDoublePt GetDynamicContentChanges();
+    /**
+     * Store the dynamic content change in an external storage (e.g., the contiguous storage of the processor).
+     *
+     * @param value pointer to the external storage.
+     */
+    void LinkDynamicContentChange(double* value);
+
+    /**
+     * Store the dynamic content change back in the local storage of the container.
+     */
+    void UnlinkDynamicContentChange();
 
     bool HasMaximumCapacity() const {
         return m_capacity != nullptr;
@@ -39,6 +49,10 @@ class WaterContainer : public wxObject {
         return *m_capacity;
     }
 
+    const float* GetMaximumCapacityPointer() const {
+        return m_capacity;
+    }
+
     void SetMaximumCapacity(float* value) {
         if (m_infiniteStorage) {
             throw ConceptionIssue(_("Trying to set the maximum capacity of an infinite storage."));
@@ -51,6 +65,10 @@ class WaterContainer : public wxObject {
         m_infiniteStorage = true;
     }
 
+    bool IsInfiniteStorage() const {
+        return m_infiniteStorage;
+    }
+
     /**
      * Get the water content of the current object.
      *
@@ -61,7 +79,7 @@ class WaterContainer : public wxObject {
             return INFINITY;
         }
 
-        return m_content + m_contentChangeDynamic + m_contentChangeStatic;
+        return m_content + *m_contentChangeDynamic + m_contentChangeStatic;
     }
 
     double GetContentWithDynamicChanges() const {
@@ -69,7 +87,7 @@ class WaterContainer : public wxObject {
             return INFINITY;
         }
 
-        return m_content + m_contentChangeDynamic;
+        return m_content + *m_contentChangeDynamic;
     }
 
     double GetContentWithoutChanges() const {
@@ -80,6 +98,14 @@ class WaterContainer : public wxObject {
         return m_content;
     }
 
+    double GetStaticContentChange() const {
+        return m_contentChangeStatic;
+    }
+
+    void SetStaticContentChange(double change) {
+        m_contentChangeStatic = change;
+    }
+
     double* GetContentPointer() {
         return &m_content;
     }
@@ -92,6 +118,16 @@ class WaterContainer : public wxObject {
         m_content = value;
     }
 
+    /**
+     * Copy the content and the initial state of another container having the same role (e.g. in a model replica).
+     *
+     * @param other The container to copy the state from.
+     */
+    void CopyStateFrom(const WaterContainer* other) {
+        m_content = other->m_content;
+        m_initialState = other->m_initialState;
+    }
+
     double GetTargetFillingRatio();
 
     bool IsNotEmpty() {
@@ -99,6 +135,16 @@ class WaterContainer : public wxObject {
         return content > EPSILON_F && content > PRECISION;
     }
 
+    /**
+     * Check if the container is empty and has no pending change. Its processes cannot produce any flux then.
+     *
+     * @return True if the container is quiescent.
+     */
+    bool IsQuiescent() const {
+        return !m_infiniteStorage && m_content <= PRECISION && *m_contentChangeDynamic == 0 &&
+               m_contentChangeStatic == 0;
+    }
+
     bool HasOverflow() {
         return m_overflow != nullptr;
     }
@@ -107,6 +153,10 @@ class WaterContainer : public wxObject {
         m_overflow = overflow;
     }
 
+    Process* GetOverflow() {
+        return m_overflow;
+    }
+
     /**
      * Attach incoming flux.
      *
@@ -117,6 +167,10 @@ class WaterContainer : public wxObject {
         m_inputs.push_back(flux);
     }
 
+    vector<Flux*>& GetInputFluxes() {
+        return m_inputs;
+    }
+
     /**
      * Sums the water amount from the different fluxes.
      *
@@ -132,10 +186,11 @@ class WaterContainer : public wxObject {
 
   protected:
   private:
-    double m_content;               // [mm]
-    double m_contentChangeDynamic;  // [mm]
-    double m_contentChangeStatic;   // [mm]
-    double m_initialState;          // [mm]
+    double m_content;                    // [mm]
+    double* m_contentChangeDynamic;      // [mm] Local or in the storage of the processor
+    double m_contentChangeDynamicLocal;  // [mm]
+    double m_contentChangeStatic;        // [mm]
+    double m_initialState;               // [mm]
     float* m_capacity;
     bool m_infiniteStorage;
     Brick* m_parent;
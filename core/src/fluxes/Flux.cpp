@@ -11,10 +11,34 @@ Flux::Flux()
       m_fractionLandCover(1.0),
       m_fractionTotal(1.0),
       m_modifier(nullptr),
+      m_modifiedAmount(0),
       m_type("water") {}
 
+Flux::~Flux() {
+    wxDELETE(m_modifier);
+}
+
 void Flux::Reset() {
     m_amount = 0;
+    m_modifiedAmount = 0;
+    if (m_modifier) {
+        m_modifier->Reset();
+    }
+}
+
+void Flux::ResetAmount() {
+    m_amount = 0;
+}
+
+void Flux::ApplyModifier() {
+    if (m_modifier) {
+        m_modifiedAmount = m_modifier->Apply(m_amount);
+    }
+}
+
+void Flux::SetModifier(Modifier* modifier) {
+    wxDELETE(m_modifier);
+    m_modifier = modifier;
 }
 
 void Flux::UpdateFlux(double amount) {
@@ -9,6 +9,8 @@ class Flux : public wxObject {
   public:
     explicit Flux();
 
+    ~Flux() override;
+
     /**
      * Check that everything is correctly defined.
      *
@@ -18,6 +20,12 @@ class Flux : public wxObject {
 
     virtual void Reset();
 
+    /**
+     * Null the amount of the time step only. Contrary to Reset(), the water delayed by the modifier keeps flowing
+     * out in the following time steps.
+     */
+    void ResetAmount();
+
     /**
      * Get the amount of water outgoing the flux.
      *
@@ -32,6 +40,26 @@ class Flux : public wxObject {
      */
     virtual void UpdateFlux(double amount);
 
+    /**
+     * Apply the modifier (if any) to the amount of the time step. Must be called once per time step.
+     */
+    void ApplyModifier();
+
+    /**
+     * Set a modifier transforming the amounts over time. The flux takes ownership of the modifier.
+     *
+     * @param modifier The modifier.
+     */
+    void SetModifier(Modifier* modifier);
+
+    Modifier* GetModifier() {
+        return m_modifier;
+    }
+
+    bool HasModifier() {
+        return m_modifier != nullptr;
+    }
+
     void LinkChangeRate(double* rate) {
         m_changeRate = rate;
     }
@@ -99,6 +127,7 @@ class Flux : public wxObject {
     double m_fractionLandCover;
     double m_fractionTotal;
     Modifier* m_modifier;
+    double m_modifiedAmount;
     string m_type;
 
   private:
@@ -21,6 +21,10 @@ class FluxForcing : public Flux {
 
     void AttachForcing(Forcing* forcing);
 
+    Forcing* GetForcing() {
+        return m_forcing;
+    }
+
     bool IsForcing() override {
         return true;
     }
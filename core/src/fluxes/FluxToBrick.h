@@ -22,6 +22,10 @@ class FluxToBrick : public Flux {
 
     void UpdateFlux(double amount) override;
 
+    Brick* GetTargetBrick() {
+        return m_toBrick;
+    }
+
   protected:
     Brick* m_toBrick;
 
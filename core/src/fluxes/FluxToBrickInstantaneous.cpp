@@ -3,7 +3,9 @@
 #include "Brick.h"
 
 FluxToBrickInstantaneous::FluxToBrickInstantaneous(Brick* brick)
-    : FluxToBrick(brick) {}
+    : FluxToBrick(brick),
+      m_deferred(false),
+      m_pendingAmount(0) {}
 
 bool FluxToBrickInstantaneous::IsOk() {
     return true;
@@ -24,5 +26,23 @@ void FluxToBrickInstantaneous::UpdateFlux(double amount) {
     } else {
         m_amount = amount;
     }
+    if (m_deferred) {
+        m_pendingAmount += m_amount;
+        return;
+    }
     m_toBrick->GetWaterContainer()->AddAmountToStaticContentChange(m_amount);
 }
+
+void FluxToBrickInstantaneous::Reset() {
+    Flux::Reset();
+    m_pendingAmount = 0;
+}
+
+void FluxToBrickInstantaneous::TransferPendingAmount() {
+    wxASSERT(m_toBrick);
+    if (m_pendingAmount == 0) {
+        return;
+    }
+    m_toBrick->GetWaterContainer()->AddAmountToStaticContentChange(m_pendingAmount);
+    m_pendingAmount = 0;
+}
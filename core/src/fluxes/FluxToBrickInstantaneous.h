@@ -28,7 +28,25 @@ class FluxToBrickInstantaneous : public FluxToBrick {
 
     void UpdateFlux(double amount) override;
 
+    void Reset() override;
+
+    /**
+     * Keep the amounts as pending instead of transferring them directly to the target brick. This is needed when
+     * the target brick is shared by elements processed concurrently.
+     */
+    void DeferTransfer() {
+        m_deferred = true;
+    }
+
+    /**
+     * Transfer the pending amount to the target brick.
+     */
+    void TransferPendingAmount();
+
   protected:
+    bool m_deferred;
+    double m_pendingAmount;
+
   private:
 };
 
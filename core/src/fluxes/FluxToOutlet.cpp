@@ -8,5 +8,9 @@ bool FluxToOutlet::IsOk() {
 }
 
 double FluxToOutlet::GetAmount() {
+    if (m_modifier) {
+        return m_modifiedAmount;
+    }
+
     return m_amount;
 }
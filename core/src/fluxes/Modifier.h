@@ -3,14 +3,50 @@
 
 #include "Includes.h"
 
+/**
+ * Transformation of the amounts carried by a flux over time (e.g. routing delay). The modifier is applied once per
+ * time step and can keep a memory of the previous amounts.
+ */
 class Modifier : public wxObject {
   public:
     explicit Modifier();
 
     ~Modifier() override = default;
 
-  protected:
-  private:
+    /**
+     * Reset the memory of the modifier.
+     */
+    virtual void Reset() = 0;
+
+    /**
+     * Process the amount of the current time step.
+     *
+     * @param amount The amount entering the flux during the time step.
+     * @return The amount delivered by the flux during the time step.
+     */
+    virtual double Apply(double amount) = 0;
+
+    /**
+     * Get the number of values describing the memory of the modifier.
+     *
+     * @return The number of state values.
+     */
+    virtual int GetStateSize() const = 0;
+
+    /**
+     * Append the memory of the modifier to a state vector.
+     *
+     * @param state The state vector to append to.
+     */
+    virtual void GetState(vecDouble& state) const = 0;
+
+    /**
+     * Restore the memory of the modifier.
+     *
+     * @param values Pointer to the state values of the modifier.
+     * @return Pointer to the values following those of the modifier.
+     */
+    virtual const double* SetState(const double* values) = 0;
 };
 
 #endif  // HYDROBRICKS_MODIFIER_H
@@ -1,3 +1,163 @@
 #include "ModifierLag.h"
 
-ModifierLag::ModifierLag() {}
+#include <functional>
+#include <unsupported/Eigen/FFT>
+#include <unsupported/Eigen/SpecialFunctions>
+
+// Fraction of the unit hydrograph that can be neglected when truncating long-tailed kernels.
+static const double KERNEL_TAIL_FRACTION = 1e-6;
+static const int KERNEL_MAX_LENGTH = 10000;
+
+// Kernel length from which the whole-series convolution is done by FFT.
+static const int FFT_MIN_KERNEL_LENGTH = 64;
+
+ModifierLag::ModifierLag(const vecDouble& weights)
+    : m_weights(weights),
+      m_pending(weights.size(), 0),
+      m_head(0) {
+    wxASSERT(!weights.empty());
+}
+
+ModifierLag* ModifierLag::Create(const string& kernel, const vecDouble& parameters) {
+    return new ModifierLag(BuildKernel(kernel, parameters));
+}
+
+vecDouble ModifierLag::BuildKernel(const string& kernel, const vecDouble& parameters) {
+    if (parameters.size() != 2) {
+        throw InvalidArgument(wxString::Format(_("The lag kernel '%s' needs 2 parameters (%d given)."), kernel,
+                                               int(parameters.size())));
+    }
+
+    // Cumulative distribution of the kernel, integrated over every time step.
+    std::function<double(double)> cumulative;
+    int length = KERNEL_MAX_LENGTH;
+
+    if (kernel == "triangular") {
+        double timeToPeak = parameters[0];
+        double baseTime = parameters[1];
+        if (baseTime <= 0 || timeToPeak < 0 || timeToPeak > baseTime) {
+            throw InvalidArgument(_("The triangular lag kernel needs 0 <= time to peak <= base time (> 0)."));
+        }
+        cumulative = [timeToPeak, baseTime](double t) {
+            if (t <= timeToPeak) {
+                return t * t / (timeToPeak * baseTime);
+            }
+            if (t < baseTime) {
+                return 1.0 - (baseTime - t) * (baseTime - t) / (baseTime * (baseTime - timeToPeak));
+            }
+            return 1.0;
+        };
+        length = int(std::ceil(baseTime));
+
+    } else if (kernel == "gamma" || kernel == "nash_cascade") {
+        // The Nash cascade of n linear reservoirs of constant k is a gamma distribution of shape n and scale k.
+        double shape = parameters[0];
+        double scale = parameters[1];
+        if (shape <= 0 || scale <= 0) {
+            throw InvalidArgument(
+                wxString::Format(_("The parameters of the lag kernel '%s' must be positive."), kernel));
+        }
+        cumulative = [shape, scale](double t) { return Eigen::numext::igamma(shape, t / scale); };
+
+    } else {
+        throw InvalidArgument(wxString::Format(_("The lag kernel '%s' is not recognized."), kernel));
+    }
+
+    vecDouble weights;
+    double previous = 0;
+    for (int i = 0; i < length; ++i) {
+        double current = cumulative(double(i + 1));
+        weights.push_back(current - previous);
+        previous = current;
+        if (current >= 1.0 - KERNEL_TAIL_FRACTION) {
+            break;
+        }
+    }
+
+    // Renormalize the truncated kernel to conserve the mass.
+    for (auto& weight : weights) {
+        weight /= previous;
+    }
+
+    return weights;
+}
+
+axd ModifierLag::ConvolveSeries(const axd& series, const vecDouble& weights) {
+    auto size = int(series.size());
+    auto length = int(weights.size());
+    axd routed = axd::Zero(size);
+    if (size == 0 || length == 0) {
+        return routed;
+    }
+
+    if (length < FFT_MIN_KERNEL_LENGTH) {
+        for (int t = 0; t < size; ++t) {
+            for (int k = 0; k < length && k <= t; ++k) {
+                routed[t] += weights[k] * series[t - k];
+            }
+        }
+        return routed;
+    }
+
+    // Zero-padded to avoid the circular wrap of the FFT convolution.
+    int paddedSize = size + length - 1;
+    vecDouble paddedSeries(paddedSize, 0);
+    vecDouble paddedWeights(paddedSize, 0);
+    std::copy(series.data(), series.data() + size, paddedSeries.begin());
+    std::copy(weights.begin(), weights.end(), paddedWeights.begin());
+
+    Eigen::FFT<double> fft;
+    vector<std::complex<double>> seriesSpectrum;
+    vector<std::complex<double>> weightsSpectrum;
+    fft.fwd(seriesSpectrum, paddedSeries);
+    fft.fwd(weightsSpectrum, paddedWeights);
+    for (int i = 0; i < seriesSpectrum.size(); ++i) {
+        seriesSpectrum[i] *= weightsSpectrum[i];
+    }
+    vecDouble convolution;
+    fft.inv(convolution, seriesSpectrum);
+
+    for (int t = 0; t < size; ++t) {
+        routed[t] = convolution[t];
+    }
+
+    return routed;
+}
+
+void ModifierLag::Reset() {
+    std::fill(m_pending.begin(), m_pending.end(), 0);
+    m_head = 0;
+}
+
+double ModifierLag::Apply(double amount) {
+    // Spread the amount over the future time steps, in two contiguous segments of the ring buffer.
+    auto length = int(m_weights.size());
+    int tail = length - m_head;
+    for (int k = 0; k < tail; ++k) {
+        m_pending[m_head + k] += m_weights[k] * amount;
+    }
+    for (int k = tail; k < length; ++k) {
+        m_pending[k - tail] += m_weights[k] * amount;
+    }
+
+    // Release the amount of the current time step and recycle its slot for the last future step.
+    double released = m_pending[m_head];
+    m_pending[m_head] = 0;
+    m_head = (m_head + 1) % length;
+
+    return released;
+}
+
+void ModifierLag::GetState(vecDouble& state) const {
+    // Stored in chronological order, independently of the position of the head.
+    for (int k = 0; k < m_pending.size(); ++k) {
+        state.push_back(m_pending[(m_head + k) % m_pending.size()]);
+    }
+}
+
+const double* ModifierLag::SetState(const double* values) {
+    std::copy(values, values + m_pending.size(), m_pending.begin());
+    m_head = 0;
+
+    return values + m_pending.size();
+}
@@ -4,14 +4,84 @@
 #include "Includes.h"
 #include "Modifier.h"
 
+/**
+ * Lag of a flux by convolution with a unit hydrograph. The amount entering during a time step is spread over the
+ * following time steps according to the kernel weights. The future outflows are accumulated in a ring buffer, so that
+ * the cost per time step is proportional to the kernel length, without any allocation.
+ */
 class ModifierLag : public Modifier {
   public:
-    explicit ModifierLag();
+    explicit ModifierLag(const vecDouble& weights);
 
     ~ModifierLag() override = default;
 
+    /**
+     * Create a lag modifier from a kernel definition.
+     *
+     * @param kernel The kernel type: "triangular", "gamma" or "nash_cascade".
+     * @param parameters The kernel parameters, expressed in time steps: the time to peak and the base time
+     * (triangular), the shape and the scale (gamma), or the number of reservoirs and their storage constant
+     * (nash_cascade).
+     * @return The modifier.
+     */
+    static ModifierLag* Create(const string& kernel, const vecDouble& parameters);
+
+    /**
+     * Compute the weights of a unit hydrograph by integrating the kernel over every time step. Long-tailed kernels
+     * are truncated once the remaining fraction becomes negligible and renormalized to conserve the mass.
+     *
+     * @param kernel The kernel type: "triangular", "gamma" or "nash_cascade".
+     * @param parameters The kernel parameters, expressed in time steps (see Create()).
+     * @return The weights, summing up to 1.
+     */
+    static vecDouble BuildKernel(const string& kernel, const vecDouble& parameters);
+
+    /**
+     * Convolve a whole series with the kernel weights, as when routing the outlet discharge after the simulation.
+     * Long kernels are convolved by FFT. Missing values (NaN) then contaminate the whole series and must be filled
+     * beforehand.
+     *
+     * @param series The series to route.
+     * @param weights The kernel weights.
+     * @return The routed series, of the same length (the water leaving after the end is discarded).
+     */
+    static axd ConvolveSeries(const axd& series, const vecDouble& weights);
+
+    /**
+     * @copydoc Modifier::Reset()
+     */
+    void Reset() override;
+
+    /**
+     * @copydoc Modifier::Apply()
+     */
+    double Apply(double amount) override;
+
+    /**
+     * @copydoc Modifier::GetStateSize()
+     */
+    int GetStateSize() const override {
+        return int(m_pending.size());
+    }
+
+    /**
+     * @copydoc Modifier::GetState()
+     */
+    void GetState(vecDouble& state) const override;
+
+    /**
+     * @copydoc Modifier::SetState()
+     */
+    const double* SetState(const double* values) override;
+
+    const vecDouble& GetWeights() const {
+        return m_weights;
+    }
+
   protected:
-  private:
+    vecDouble m_weights;
+    vecDouble m_pending;  // Future outflows, starting at m_head for the current time step.
+    int m_head;
 };
 
 #endif  // HYDROBRICKS_MODIFIER_LAG_H
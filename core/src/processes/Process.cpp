@@ -144,14 +144,22 @@ float* Process::GetParameterValuePointer(const ProcessSettings& processSettings,
     throw MissingParameter(wxString::Format(_("The parameter '%s' could not be found."), name));
 }
 
-vecDouble Process::GetChangeRates() {
+void Process::GetChangeRates(double* rates) {
     if (m_container->GetContentWithChanges() <= PRECISION) {
-        vecDouble res(GetConnectionsNb());
-        std::fill(res.begin(), res.end(), 0);
-        return res;
+        std::fill(rates, rates + GetConnectionsNb(), 0);
+        return;
     }
 
-    return GetRates();
+    GetRates(rates);
+}
+
+RateKernel Process::GetRateKernel() {
+    RateKernel kernel;
+    kernel.type = RateKernelType::Generic;
+    kernel.process = this;
+    kernel.container = m_container;
+
+    return kernel;
 }
 
 void Process::StoreInOutgoingFlux(double* rate, int index) {
@@ -178,14 +186,12 @@ double* Process::GetValuePointer(const string&) {
 double Process::GetSumChangeRatesOtherProcesses() {
     double sumOtherProcesses = 0;
 
-    vector<Process*> otherProcesses = m_container->GetParentBrick()->GetProcesses();
-    for (auto process : otherProcesses) {
+    for (auto process : m_container->GetParentBrick()->GetProcesses()) {
         wxASSERT(process);
         if (process == this) {
             continue;
         }
-        vector<Flux*> fluxes = process->GetOutputFluxes();
-        for (auto flux : fluxes) {
+        for (auto flux : process->GetOutputFluxes()) {
             wxASSERT(flux);
             sumOtherProcesses += *flux->GetAmountPointer();
         }
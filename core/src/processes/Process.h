@@ -4,6 +4,7 @@
 #include "Flux.h"
 #include "Forcing.h"
 #include "Includes.h"
+#include "RateKernel.h"
 #include "SettingsModel.h"
 
 class Brick;
@@ -86,7 +87,7 @@ class Process : public wxObject {
         m_outputs.push_back(flux);
     }
 
-    vector<Flux*> GetOutputFluxes() {
+    vector<Flux*>& GetOutputFluxes() {
         return m_outputs;
     }
 
@@ -102,9 +103,41 @@ class Process : public wxObject {
         return false;
     }
 
+    /**
+     * Check if the outflow is proportional to the content (rate = response factor * content), which allows an
+     * analytical integration over the time step.
+     *
+     * @return True if the process is a linear outflow.
+     */
+    virtual bool IsLinearOutflow() {
+        return false;
+    }
+
+    /**
+     * Get the response factor of a linear outflow.
+     *
+     * @return The response factor [1/d].
+     */
+    virtual double GetResponseFactor() {
+        throw ShouldNotHappen();
+    }
+
     virtual int GetConnectionsNb() = 0;
 
-    virtual vecDouble GetChangeRates();
+    /**
+     * Compute the change rates (per day) of all connections, independently of the time step and constraints.
+     *
+     * @param rates pointer to the storage of the rates (one value per connection).
+     */
+    virtual void GetChangeRates(double* rates);
+
+    /**
+     * Get the flat description of the change rate computation used by the solver. The default kernel is generic and
+     * relies on GetChangeRates().
+     *
+     * @return The rate kernel of the process.
+     */
+    virtual RateKernel GetRateKernel();
 
     virtual void StoreInOutgoingFlux(double* rate, int index);
 
@@ -114,15 +147,6 @@ class Process : public wxObject {
         // Nothing to do here.
     }
 
-    /**
-     * Get pointers to the state variables.
-     *
-     * @return vector of pointers to the state variables.
-     */
-    virtual vecDoublePt GetStateVariables() {
-        return vecDoublePt{};
-    }
-
     virtual double* GetValuePointer(const string& name);
 
     string GetName() {
@@ -148,7 +172,12 @@ class Process : public wxObject {
 
     double GetSumChangeRatesOtherProcesses();
 
-    virtual vecDouble GetRates() = 0;
+    /**
+     * Compute the change rates (per day) when the container is not empty.
+     *
+     * @param rates pointer to the storage of the rates (one value per connection).
+     */
+    virtual void GetRates(double* rates) = 0;
 
   private:
 };
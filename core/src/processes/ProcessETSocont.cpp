@@ -24,7 +24,16 @@ void ProcessETSocont::AttachForcing(Forcing* forcing) {
     }
 }
 
-vecDouble ProcessETSocont::GetRates() {
+RateKernel ProcessETSocont::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::ETSocont;
+    kernel.forcing = m_pet;
+    kernel.exponent = m_exponent;
+
+    return kernel;
+}
+
+void ProcessETSocont::GetRates(double* rates) {
     wxASSERT(m_container->HasMaximumCapacity());
-    return {m_pet->GetValue() * pow(m_container->GetTargetFillingRatio(), m_exponent)};
+    rates[0] = ComputeRate(m_pet->GetValue(), m_container->GetTargetFillingRatio(), m_exponent);
 }
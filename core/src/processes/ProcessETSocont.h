@@ -20,11 +20,20 @@ class ProcessETSocont : public ProcessET {
 
     void AttachForcing(Forcing* forcing) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
+    static double ComputeRate(double pet, double fillingRatio, double exponent) {
+        return pet * pow(fillingRatio, exponent);
+    }
+
   protected:
     Forcing* m_pet;
     float m_exponent;
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
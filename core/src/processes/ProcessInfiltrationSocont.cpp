@@ -14,10 +14,19 @@ void ProcessInfiltrationSocont::SetParameters(const ProcessSettings& processSett
     Process::SetParameters(processSettings);
 }
 
-vecDouble ProcessInfiltrationSocont::GetRates() {
+RateKernel ProcessInfiltrationSocont::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::InfiltrationSocont;
+    kernel.target = m_targetBrick->GetWaterContainer();
+
+    return kernel;
+}
+
+void ProcessInfiltrationSocont::GetRates(double* rates) {
     if (GetTargetCapacity() <= 0) {
-        return {0};
+        rates[0] = 0;
+        return;
     }
 
-    return {m_container->GetContentWithChanges() * (1 - pow(GetTargetFillingRatio(), 2))};
+    rates[0] = ComputeRate(m_container->GetContentWithChanges(), GetTargetFillingRatio());
 }
@@ -18,8 +18,17 @@ class ProcessInfiltrationSocont : public ProcessInfiltration {
      */
     void SetParameters(const ProcessSettings& processSettings) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
+    static double ComputeRate(double content, double targetFillingRatio) {
+        return content * (1 - pow(targetFillingRatio, 2));
+    }
+
   protected:
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
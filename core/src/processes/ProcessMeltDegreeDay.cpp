@@ -46,9 +46,10 @@ void ProcessMeltDegreeDay::AttachForcing(Forcing* forcing) {
     }
 }
 
-vecDouble ProcessMeltDegreeDay::GetRates() {
+void ProcessMeltDegreeDay::GetRates(double* rates) {
     if (!m_container->ContentAccessible()) {
-        return {0};
+        rates[0] = 0;
+        return;
     }
 
     double melt = 0;
@@ -56,5 +57,5 @@ vecDouble ProcessMeltDegreeDay::GetRates() {
         melt = (m_temperature->GetValue() - *m_meltingTemperature) * *m_degreeDayFactor;
     }
 
-    return {melt};
+    rates[0] = melt;
 }
@@ -27,7 +27,7 @@ class ProcessMeltDegreeDay : public ProcessMelt {
     float* m_degreeDayFactor;
     float* m_meltingTemperature;
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -68,9 +68,10 @@ void ProcessMeltDegreeDayAspect::AttachForcing(Forcing* forcing) {
     }
 }
 
-vecDouble ProcessMeltDegreeDayAspect::GetRates() {
+void ProcessMeltDegreeDayAspect::GetRates(double* rates) {
     if (!m_container->ContentAccessible()) {
-        return {0};
+        rates[0] = 0;
+        return;
     }
 
     double melt = 0;
@@ -78,5 +79,5 @@ vecDouble ProcessMeltDegreeDayAspect::GetRates() {
         melt = (m_temperature->GetValue() - *m_meltingTemperature) * *m_degreeDayFactor;
     }
 
-    return {melt};
+    rates[0] = melt;
 }
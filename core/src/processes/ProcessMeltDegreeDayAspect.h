@@ -30,7 +30,7 @@ class ProcessMeltDegreeDayAspect : public ProcessMelt {
     float* m_degreeDayFactor;
     float* m_meltingTemperature;
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -59,9 +59,10 @@ void ProcessMeltTemperatureIndex::AttachForcing(Forcing* forcing) {
     }
 }
 
-vecDouble ProcessMeltTemperatureIndex::GetRates() {
+void ProcessMeltTemperatureIndex::GetRates(double* rates) {
     if (!m_container->ContentAccessible()) {
-        return {0};
+        rates[0] = 0;
+        return;
     }
 
     double melt = 0;
@@ -70,5 +71,5 @@ vecDouble ProcessMeltTemperatureIndex::GetRates() {
                (*m_meltFactor + *m_radiationCoefficient * m_potentialClearSkyDirectSolarRadiation->GetValue());
     }
 
-    return {melt};
+    rates[0] = melt;
 }
@@ -29,7 +29,7 @@ class ProcessMeltTemperatureIndex : public ProcessMelt {
     float* m_meltingTemperature;
     float* m_radiationCoefficient;
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -6,8 +6,15 @@
 ProcessOutflowDirect::ProcessOutflowDirect(WaterContainer* container)
     : ProcessOutflow(container) {}
 
-vecDouble ProcessOutflowDirect::GetRates() {
-    return {m_container->GetContentWithChanges()};
+RateKernel ProcessOutflowDirect::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::OutflowDirect;
+
+    return kernel;
+}
+
+void ProcessOutflowDirect::GetRates(double* rates) {
+    rates[0] = m_container->GetContentWithChanges();
 }
 
 void ProcessOutflowDirect::RegisterProcessParametersAndForcing(SettingsModel*) {
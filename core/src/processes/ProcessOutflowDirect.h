@@ -13,8 +13,13 @@ class ProcessOutflowDirect : public ProcessOutflow {
 
     static void RegisterProcessParametersAndForcing(SettingsModel* modelSettings);
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
   protected:
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -16,6 +16,14 @@ void ProcessOutflowLinear::SetParameters(const ProcessSettings& processSettings)
     m_responseFactor = GetParameterValuePointer(processSettings, "response_factor");
 }
 
-vecDouble ProcessOutflowLinear::GetRates() {
-    return {(*m_responseFactor) * m_container->GetContentWithChanges()};
+RateKernel ProcessOutflowLinear::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::OutflowLinear;
+    kernel.parameter = m_responseFactor;
+
+    return kernel;
+}
+
+void ProcessOutflowLinear::GetRates(double* rates) {
+    rates[0] = ComputeRate(m_container->GetContentWithChanges(), *m_responseFactor);
 }
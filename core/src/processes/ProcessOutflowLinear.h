@@ -18,10 +18,27 @@ class ProcessOutflowLinear : public ProcessOutflow {
      */
     void SetParameters(const ProcessSettings& processSettings) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
+    static double ComputeRate(double content, double responseFactor) {
+        return responseFactor * content;
+    }
+
+    bool IsLinearOutflow() override {
+        return true;
+    }
+
+    double GetResponseFactor() override {
+        return *m_responseFactor;
+    }
+
   protected:
     float* m_responseFactor;  // [1/d]
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
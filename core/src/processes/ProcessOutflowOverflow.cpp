@@ -14,8 +14,15 @@ void ProcessOutflowOverflow::SetParameters(const ProcessSettings& processSetting
     Process::SetParameters(processSettings);
 }
 
-vecDouble ProcessOutflowOverflow::GetRates() {
-    return {0};
+RateKernel ProcessOutflowOverflow::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::Zero;
+
+    return kernel;
+}
+
+void ProcessOutflowOverflow::GetRates(double* rates) {
+    rates[0] = 0;
 }
 
 void ProcessOutflowOverflow::StoreInOutgoingFlux(double* rate, int index) {
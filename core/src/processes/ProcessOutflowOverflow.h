@@ -18,10 +18,15 @@ class ProcessOutflowOverflow : public ProcessOutflow {
      */
     void SetParameters(const ProcessSettings& processSettings) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
     void StoreInOutgoingFlux(double* rate, int index) override;
 
   protected:
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -20,6 +20,14 @@ void ProcessOutflowPercolation::SetParameters(const ProcessSettings& processSett
     }
 }
 
-vecDouble ProcessOutflowPercolation::GetRates() {
-    return {*m_rate};
+RateKernel ProcessOutflowPercolation::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::OutflowPercolation;
+    kernel.parameter = m_rate;
+
+    return kernel;
+}
+
+void ProcessOutflowPercolation::GetRates(double* rates) {
+    rates[0] = *m_rate;
 }
@@ -18,10 +18,15 @@ class ProcessOutflowPercolation : public ProcessOutflow {
      */
     void SetParameters(const ProcessSettings& processSettings) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
   protected:
     float* m_rate;  // [mm/d]
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
@@ -10,6 +10,6 @@ void ProcessOutflowRestDirect::RegisterProcessParametersAndForcing(SettingsModel
     // Nothing to register
 }
 
-vecDouble ProcessOutflowRestDirect::GetRates() {
-    return {wxMax(m_container->GetContentWithChanges() - GetSumChangeRatesOtherProcesses(), 0)};
+void ProcessOutflowRestDirect::GetRates(double* rates) {
+    rates[0] = wxMax(m_container->GetContentWithChanges() - GetSumChangeRatesOtherProcesses(), 0);
 }
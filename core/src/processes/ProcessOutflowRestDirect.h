@@ -14,7 +14,7 @@ class ProcessOutflowRestDirect : public ProcessOutflow {
     static void RegisterProcessParametersAndForcing(SettingsModel* modelSettings);
 
   protected:
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
   private:
 };
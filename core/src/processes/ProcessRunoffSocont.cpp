@@ -38,7 +38,23 @@ double ProcessRunoffSocont::GetArea() {
     return m_areaUnit;
 }
 
-vecDouble ProcessRunoffSocont::GetRates() {
+RateKernel ProcessRunoffSocont::GetRateKernel() {
+    RateKernel kernel = Process::GetRateKernel();
+    kernel.type = RateKernelType::RunoffSocont;
+    kernel.parameter = m_beta;
+    kernel.areaFraction = m_areaFraction;
+    kernel.area = m_areaUnit;
+    kernel.slope = m_slope;
+    kernel.exponent = m_exponent;
+
+    return kernel;
+}
+
+void ProcessRunoffSocont::GetRates(double* rates) {
+    rates[0] = ComputeRate(m_container->GetContentWithChanges(), *m_beta, m_slope, GetArea(), m_exponent);
+}
+
+double ProcessRunoffSocont::ComputeRate(double content, double beta, double slope, double area, double exponent) {
     // Considers the runoff on an inclined plane with a water depth of 0 at the top and of h at the bottom.
     // The water depth is assumed to be linear from the top to the bottom of the plane.
     // The storage shape is the ratio between the water depth at the bottom and the average water depth -> 2.
@@ -46,11 +62,11 @@ vecDouble ProcessRunoffSocont::GetRates() {
     const double dt = 86400;  // [s] number of seconds in a day
 
     // h is the water depth at the bottom of the plane != average water depth
-    double h = m_container->GetContentWithChanges() * storageShape / 1000;  // [m]
+    double h = content * storageShape / 1000;  // [m]
 
-    double qQuick = *m_beta * pow(m_slope, 0.5) * pow(h, m_exponent) / GetArea();  // [m/s]
-    double dh = qQuick * storageShape * dt;                                        // [m]
-    double runoff = (dh / storageShape) * 1000;                                    // [mm]
+    double qQuick = beta * pow(slope, 0.5) * pow(h, exponent) / area;  // [m/s]
+    double dh = qQuick * storageShape * dt;                            // [m]
+    double runoff = (dh / storageShape) * 1000;                        // [mm]
 
-    return {wxMin(runoff, m_container->GetContentWithChanges())};
+    return wxMin(runoff, content);
 }
@@ -25,6 +25,23 @@ class ProcessRunoffSocont : public ProcessOutflow {
      */
     void SetParameters(const ProcessSettings& processSettings) override;
 
+    /**
+     * @copydoc Process::GetRateKernel()
+     */
+    RateKernel GetRateKernel() override;
+
+    /**
+     * Compute the runoff rate [mm/d].
+     *
+     * @param content The water content [mm].
+     * @param beta The beta parameter [].
+     * @param slope The slope [m/m].
+     * @param area The area of the runoff surface [m^2].
+     * @param exponent The exponent of the water depth [].
+     * @return The runoff rate [mm/d].
+     */
+    static double ComputeRate(double content, double beta, double slope, double area, double exponent);
+
   protected:
     float m_slope;           // []
     float* m_beta;           // []
@@ -32,7 +49,7 @@ class ProcessRunoffSocont : public ProcessOutflow {
     double m_areaUnit;       // [m^2]
     double m_exponent;
 
-    vecDouble GetRates() override;
+    void GetRates(double* rates) override;
 
     double GetArea();
 
@@ -0,0 +1,39 @@
+#ifndef HYDROBRICKS_RATE_KERNEL_H
+#define HYDROBRICKS_RATE_KERNEL_H
+
+#include "Includes.h"
+
+class Forcing;
+class Process;
+class WaterContainer;
+
+enum class RateKernelType {
+    Generic,
+    Zero,
+    OutflowLinear,
+    OutflowPercolation,
+    OutflowDirect,
+    InfiltrationSocont,
+    ETSocont,
+    RunoffSocont
+};
+
+/**
+ * Flat description of the change rate computation of a process. It allows the solver to evaluate the rates of the
+ * most common processes (e.g., those of the Socont structure) in a single inlined loop. The other processes are
+ * flagged as generic and evaluated through Process::GetChangeRates().
+ */
+struct RateKernel {
+    RateKernelType type = RateKernelType::Generic;
+    Process* process = nullptr;
+    WaterContainer* container = nullptr;
+    WaterContainer* target = nullptr;
+    Forcing* forcing = nullptr;
+    const float* parameter = nullptr;
+    const double* areaFraction = nullptr;
+    double area = 0;
+    double slope = 0;
+    double exponent = 0;
+};
+
+#endif  // HYDROBRICKS_RATE_KERNEL_H
@@ -14,3 +14,10 @@ void Connector::Connect(SubBasin* in, SubBasin* out) {
     m_in->AddOutputConnector(this);
     m_out->AddInputConnector(this);
 }
+
+double Connector::GetDischarge() {
+    wxASSERT(m_in);
+    wxASSERT(m_out);
+    wxASSERT(m_out->GetArea() > 0);
+    return m_in->GetOutletTotal() * m_in->GetArea() / m_out->GetArea();
+}
@@ -13,6 +13,21 @@ class Connector : public wxObject {
 
     void Connect(SubBasin* in, SubBasin* out);
 
+    /**
+     * Get the outlet discharge of the upstream sub basin, expressed over the area of the downstream sub basin.
+     *
+     * @return The discharge [mm].
+     */
+    double GetDischarge();
+
+    SubBasin* GetUpstream() {
+        return m_in;
+    }
+
+    SubBasin* GetDownstream() {
+        return m_out;
+    }
+
   protected:
     SubBasin* m_in;
     SubBasin* m_out;
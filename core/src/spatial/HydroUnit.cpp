@@ -1,6 +1,7 @@
 #include "HydroUnit.h"
 
 #include "SettingsBasin.h"
+#include "SurfaceComponent.h"
 
 HydroUnit::HydroUnit(double area, Types type)
     : m_type(type),
@@ -28,6 +29,39 @@ void HydroUnit::SaveAsInitialState() {
     }
 }
 
+HydroUnit* HydroUnit::CloneWithoutComponents() const {
+    auto unit = new HydroUnit(m_area, m_type);
+    unit->SetId(m_id);
+    for (auto property : m_properties) {
+        unit->AddProperty(new HydroUnitProperty(*property));
+    }
+
+    return unit;
+}
+
+void HydroUnit::CopyStateFrom(HydroUnit* other) {
+    wxASSERT(m_bricks.size() == other->m_bricks.size());
+
+    // The land covers first, as the fractions of the surface components depend on them.
+    for (int i = 0; i < m_bricks.size(); ++i) {
+        if (m_bricks[i]->IsLandCover()) {
+            auto landCover = dynamic_cast<LandCover*>(m_bricks[i]);
+            auto otherLandCover = dynamic_cast<LandCover*>(other->m_bricks[i]);
+            wxASSERT(landCover && otherLandCover);
+            landCover->SetAreaFraction(otherLandCover->GetAreaFraction());
+        }
+    }
+    for (int i = 0; i < m_bricks.size(); ++i) {
+        if (m_bricks[i]->CanHaveAreaFraction() && !m_bricks[i]->IsLandCover()) {
+            auto surfaceComponent = dynamic_cast<SurfaceComponent*>(m_bricks[i]);
+            auto otherSurfaceComponent = dynamic_cast<SurfaceComponent*>(other->m_bricks[i]);
+            wxASSERT(surfaceComponent && otherSurfaceComponent);
+            surfaceComponent->SetAreaFraction(otherSurfaceComponent->GetAreaFraction());
+        }
+        m_bricks[i]->CopyStateFrom(other->m_bricks[i]);
+    }
+}
+
 void HydroUnit::SetProperties(HydroUnitSettings& unitSettings) {
     m_id = unitSettings.id;
 
@@ -27,6 +27,20 @@ class HydroUnit : public wxObject {
 
     void SaveAsInitialState();
 
+    /**
+     * Create a copy of the hydro unit (identifier, area and properties) without its bricks, splitters and forcing.
+     *
+     * @return The new hydro unit.
+     */
+    HydroUnit* CloneWithoutComponents() const;
+
+    /**
+     * Copy the area fractions and the state of the bricks of an hydro unit having the same structure.
+     *
+     * @param other The hydro unit to copy the state from.
+     */
+    void CopyStateFrom(HydroUnit* other);
+
     void SetProperties(HydroUnitSettings& unitSettings);
 
     void AddProperty(HydroUnitProperty* property);
@@ -82,10 +82,31 @@ void SubBasin::Reset() {
 
 void SubBasin::SaveAsInitialState() {
     for (auto brick : m_bricks) {
-        brick->Reset();
+        brick->SaveAsInitialState();
     }
     for (auto hydroUnit : m_hydroUnits) {
-        hydroUnit->Reset();
+        hydroUnit->SaveAsInitialState();
+    }
+}
+
+SubBasin* SubBasin::CloneHydroUnits() const {
+    auto subBasin = new SubBasin();
+    subBasin->m_needsCleanup = true;
+    for (auto unit : m_hydroUnits) {
+        subBasin->AddHydroUnit(unit->CloneWithoutComponents());
+    }
+
+    return subBasin;
+}
+
+void SubBasin::CopyStateFrom(SubBasin* other) {
+    wxASSERT(m_bricks.size() == other->m_bricks.size());
+    wxASSERT(m_hydroUnits.size() == other->m_hydroUnits.size());
+    for (int i = 0; i < m_bricks.size(); ++i) {
+        m_bricks[i]->CopyStateFrom(other->m_bricks[i]);
+    }
+    for (int i = 0; i < m_hydroUnits.size(); ++i) {
+        m_hydroUnits[i]->CopyStateFrom(other->m_hydroUnits[i]);
     }
 }
 
@@ -254,8 +275,14 @@ double* SubBasin::GetValuePointer(const string& name) {
 bool SubBasin::ComputeOutletDischarge() {
     m_outletTotal = 0;
     for (auto flux : m_outletFluxes) {
+        flux->ApplyModifier();
         m_outletTotal += flux->GetAmount();
     }
 
+    // The upstream sub basins were processed before for this time step.
+    for (auto connector : m_inConnectors) {
+        m_outletTotal += connector->GetDischarge();
+    }
+
     return true;
 }
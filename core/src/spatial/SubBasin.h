@@ -23,6 +23,20 @@ class SubBasin : public wxObject {
 
     void SaveAsInitialState();
 
+    /**
+     * Create a new sub basin with copies of the hydro units, but without any brick, splitter or connector.
+     *
+     * @return The new sub basin (to be deleted by the caller).
+     */
+    SubBasin* CloneHydroUnits() const;
+
+    /**
+     * Copy the area fractions and the state of the bricks of a sub basin having the same structure.
+     *
+     * @param other The sub basin to copy the state from.
+     */
+    void CopyStateFrom(SubBasin* other);
+
     bool IsOk();
 
     void AddBrick(Brick* brick);
@@ -65,6 +79,10 @@ class SubBasin : public wxObject {
 
     void AttachOutletFlux(Flux* pFlux);
 
+    vector<Flux*>& GetOutletFluxes() {
+        return m_outletFluxes;
+    }
+
     double* GetValuePointer(const string& name);
 
     bool ComputeOutletDischarge();
@@ -73,6 +91,15 @@ class SubBasin : public wxObject {
         return m_area;
     }
 
+    /**
+     * Get the discharge at the outlet for the last time step, including the inflow from the upstream sub basins.
+     *
+     * @return The discharge [mm].
+     */
+    double GetOutletTotal() const {
+        return m_outletTotal;
+    }
+
   protected:
     double m_area;  // m2
     double m_outletTotal;
@@ -3,6 +3,7 @@
 #include "BehaviourLandCoverChange.h"
 #include "ModelHydro.h"
 #include "SettingsModel.h"
+#include "SolverEulerImplicit.h"
 #include "TimeSeriesUniform.h"
 #include "helpers.h"
 
@@ -192,6 +193,62 @@ TEST_F(BehavioursInModel2LandCovers, LandCoverChangeWorks) {
     EXPECT_NEAR(balance, 0.0, 0.0000001);
 }
 
+TEST_F(BehavioursInModel2LandCovers, NullLandCoversAreReactivated) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier_ice", "", 0.0);
+    basinSettings.AddLandCover("glacier_debris", "", 0.5);
+    basinSettings.AddHydroUnit(2, 100);
+    basinSettings.AddLandCover("ground", "", 1.0);
+    basinSettings.AddLandCover("glacier_ice", "", 0.0);
+    basinSettings.AddLandCover("glacier_debris", "", 0.0);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+    EXPECT_TRUE(model.IsOk());
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    // The null land covers are not processed
+    Processor* processor = model.GetProcessor();
+    int connectionsNbInitial = processor->GetNbSolvableConnections() + processor->GetNbDirectConnections();
+    Brick* glacierIce = subBasin.GetHydroUnit(0)->GetLandCover("glacier_ice");
+    vector<Brick*>& bricks = *(processor->GetIterableBricksVectorPt());
+    EXPECT_TRUE(std::find(bricks.begin(), bricks.end(), glacierIce) == bricks.end());
+
+    BehaviourLandCoverChange behaviour;
+    behaviour.AddChange(GetMJD(2020, 1, 3), 1, "glacier_ice", 20);
+    behaviour.AddChange(GetMJD(2020, 1, 5), 2, "glacier_debris", 30);
+
+    EXPECT_TRUE(model.AddBehaviour(&behaviour));
+
+    EXPECT_TRUE(model.Run());
+
+    EXPECT_GT(processor->GetNbSolvableConnections() + processor->GetNbDirectConnections(), connectionsNbInitial);
+
+    Logger* logger = model.GetLogger();
+
+    // Water balance components
+    double precip = 80;
+    double totalGlacierMelt = logger->GetTotalHydroUnits("glacier_ice:melt:output");
+    totalGlacierMelt += logger->GetTotalHydroUnits("glacier_debris:melt:output");
+    double discharge = logger->GetTotalOutletDischarge();
+    double et = logger->GetTotalET();
+    double storage = logger->GetTotalWaterStorageChanges();
+
+    // Balance
+    double balance = discharge + et + storage - precip - totalGlacierMelt;
+
+    EXPECT_NEAR(balance, 0.0, 0.0000001);
+}
+
 TEST_F(BehavioursInModel2LandCovers, DatesGetSortedCorrectly) {
     SettingsBasin basinSettings;
     basinSettings.AddHydroUnit(1, 100);
@@ -233,4 +290,88 @@ TEST_F(BehavioursInModel2LandCovers, DatesGetSortedCorrectly) {
     }
 
     EXPECT_TRUE(model.Run());
-}
\ No newline at end of file
+}
+
+class BehavioursInModelImplicit : public ::testing::Test {
+  protected:
+    SettingsModel m_model;
+    TimeSeriesUniform* m_tsPrecip{};
+
+    void SetUp() override {
+        m_model.SetSolver("euler_implicit");
+        m_model.SetTimer("2020-01-01", "2020-01-10", 1, "day");
+        m_model.GeneratePrecipitationSplitters(false);
+
+        m_model.AddHydroUnitBrick("storage", "storage");
+        m_model.AddBrickProcess("outflow", "outflow:linear", "outlet");
+
+        // Land covers having a different number of outflows
+        m_model.AddLandCoverBrick("ground", "generic_land_cover");
+        m_model.AddBrickProcess("outflow", "outflow:linear", "storage");
+        m_model.AddLandCoverBrick("item_1", "generic_land_cover");
+        m_model.AddBrickProcess("outflow", "outflow:linear", "outlet");
+        m_model.AddBrickProcess("outflow_2", "outflow:linear", "storage");
+        m_model.AddLandCoverBrick("item_2", "generic_land_cover");
+        m_model.AddBrickProcess("outflow", "outflow:linear", "outlet");
+        m_model.AddLoggingToItem("outlet");
+
+        auto precip = new TimeSeriesDataRegular(GetMJD(2020, 1, 1), GetMJD(2020, 1, 10), 1, Day);
+        precip->SetValues({0.0, 10.0, 10.0, 10.0, 10.0, 10.0, 10.0, 10.0, 0.0, 0.0});
+        m_tsPrecip = new TimeSeriesUniform(Precipitation);
+        m_tsPrecip->SetData(precip);
+    }
+    void TearDown() override {
+        wxDELETE(m_tsPrecip);
+    }
+
+    static void AddUnit(SettingsBasin& basinSettings, int id, double fraction1, double fraction2) {
+        basinSettings.AddHydroUnit(id, 100);
+        basinSettings.AddLandCover("ground", "", 1.0 - fraction1 - fraction2);
+        basinSettings.AddLandCover("item_1", "", fraction1);
+        basinSettings.AddLandCover("item_2", "", fraction2);
+    }
+};
+
+TEST_F(BehavioursInModelImplicit, SwappedLandCoversUpdateTheStateMapping) {
+    // The land covers of both units are exchanged: the number of connections is unchanged, not their order.
+    SettingsBasin basinSettings;
+    AddUnit(basinSettings, 1, 0.5, 0);
+    AddUnit(basinSettings, 2, 0, 0.5);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    BehaviourLandCoverChange behaviour;
+    behaviour.AddChange(GetMJD(2020, 1, 4), 1, "item_1", 0);
+    behaviour.AddChange(GetMJD(2020, 1, 4), 1, "item_2", 50);
+    behaviour.AddChange(GetMJD(2020, 1, 4), 2, "item_2", 0);
+    behaviour.AddChange(GetMJD(2020, 1, 4), 2, "item_1", 50);
+    EXPECT_TRUE(model.AddBehaviour(&behaviour));
+
+    Processor* processor = model.GetProcessor();
+    auto solver = dynamic_cast<SolverEulerImplicit*>(processor->GetSolver());
+    ASSERT_TRUE(solver != nullptr);
+    EXPECT_TRUE(model.Run());
+
+    // Same mapping of the rates to the state variables as a model built with the final land covers
+    SettingsBasin basinSettingsFinal;
+    AddUnit(basinSettingsFinal, 1, 0, 0.5);
+    AddUnit(basinSettingsFinal, 2, 0.5, 0);
+
+    SubBasin subBasinFinal;
+    EXPECT_TRUE(subBasinFinal.Initialize(basinSettingsFinal));
+    ModelHydro modelFinal(&subBasinFinal);
+    EXPECT_TRUE(modelFinal.Initialize(m_model, basinSettingsFinal));
+    ASSERT_TRUE(modelFinal.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(modelFinal.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(modelFinal.Run());
+
+    auto solverFinal = dynamic_cast<SolverEulerImplicit*>(modelFinal.GetProcessor()->GetSolver());
+    ASSERT_TRUE(solverFinal != nullptr);
+    EXPECT_EQ(processor->GetNbSolvableConnections(), modelFinal.GetProcessor()->GetNbSolvableConnections());
+    EXPECT_EQ(solver->GetRateSources(), solverFinal->GetRateSources());
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include "FluxToOutlet.h"
 #include "ModelHydro.h"
+#include "ModifierLag.h"
 #include "SettingsBasin.h"
 #include "SettingsModel.h"
 #include "TimeSeriesUniform.h"
@@ -345,3 +347,86 @@ TEST_F(FluxWeightedModel, TwoUnitsWithTwoLandCoverBricksDifferentArea) {
 
     EXPECT_NEAR(balance, 0.0, 0.0000001);
 }
+
+TEST(ModifierLag, KernelsAreNormalized) {
+    vecDouble triangular = ModifierLag::BuildKernel("triangular", {1.5, 4});
+    vecDouble gamma = ModifierLag::BuildKernel("gamma", {2.5, 1.2});
+    vecDouble nash = ModifierLag::BuildKernel("nash_cascade", {3, 2});
+
+    EXPECT_EQ(triangular.size(), 4);
+    EXPECT_NEAR(triangular[0], 1.0 / 6.0, 0.000001);
+    for (const auto& weights : {triangular, gamma, nash}) {
+        double sum = 0;
+        for (auto weight : weights) {
+            EXPECT_GE(weight, 0);
+            sum += weight;
+        }
+        EXPECT_NEAR(sum, 1.0, 0.0000001);
+    }
+
+    wxLogNull logNo;
+    EXPECT_THROW(ModifierLag::BuildKernel("exponential", {1, 1}), InvalidArgument);
+    EXPECT_THROW(ModifierLag::BuildKernel("triangular", {5, 4}), InvalidArgument);
+    EXPECT_THROW(ModifierLag::BuildKernel("gamma", {2}), InvalidArgument);
+}
+
+TEST(ModifierLag, RingBufferMatchesSeriesConvolution) {
+    axd series(300);
+    for (int i = 0; i < series.size(); ++i) {
+        series[i] = (i % 17 < 3) ? 10.0 + i % 5 : 0.0;
+    }
+
+    // The short kernel is convolved directly and the long one by FFT.
+    for (const auto& weights :
+         {ModifierLag::BuildKernel("triangular", {2, 6}), ModifierLag::BuildKernel("gamma", {4, 30})}) {
+        axd routed = ModifierLag::ConvolveSeries(series, weights);
+        ModifierLag modifier(weights);
+        for (int i = 0; i < series.size(); ++i) {
+            EXPECT_NEAR(modifier.Apply(series[i]), routed[i], 0.0000001);
+        }
+    }
+}
+
+TEST(ModifierLag, StateRestoresPendingOutflows) {
+    ModifierLag modifier(ModifierLag::BuildKernel("nash_cascade", {2, 1.5}));
+    for (int i = 0; i < 5; ++i) {
+        modifier.Apply(10);
+    }
+    vecDouble state;
+    modifier.GetState(state);
+    ASSERT_EQ(state.size(), modifier.GetStateSize());
+
+    vecDouble outputsRef;
+    for (int i = 0; i < 20; ++i) {
+        outputsRef.push_back(modifier.Apply(i % 3));
+    }
+
+    modifier.Reset();
+    EXPECT_EQ(modifier.SetState(state.data()), state.data() + state.size());
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_DOUBLE_EQ(modifier.Apply(i % 3), outputsRef[i]);
+    }
+}
+
+TEST(ModifierLag, ResettingTheFluxAmountKeepsTheLaggedWater) {
+    vecDouble weights = ModifierLag::BuildKernel("triangular", {2, 6});
+    FluxToOutlet flux;
+    flux.SetModifier(new ModifierLag(weights));
+    flux.UpdateFlux(10);
+    flux.ApplyModifier();
+    double total = flux.GetAmount();
+
+    // The source of the flux vanishes: the lagged water still reaches the outlet
+    flux.ResetAmount();
+    for (int i = 0; i < 10; ++i) {
+        flux.ApplyModifier();
+        total += flux.GetAmount();
+    }
+    EXPECT_NEAR(total, 10, 0.0000001);
+
+    flux.UpdateFlux(10);
+    flux.ApplyModifier();
+    flux.Reset();
+    flux.ApplyModifier();
+    EXPECT_DOUBLE_EQ(flux.GetAmount(), 0);
+}
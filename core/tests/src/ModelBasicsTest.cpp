@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+
+#include <thread>
 #include <wx/stdpaths.h>
 
 #include "ModelHydro.h"
@@ -367,3 +369,75 @@ TEST_F(ModelBasics, Model2ClosesBalance) {
 
     EXPECT_NEAR(balance, 0.0, 0.0000001);
 }
+
+TEST_F(ModelBasics, ModelsRunConcurrentlyWithDifferentTimeSteps) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    // Reference: daily model run alone
+    SubBasin subBasinRef;
+    EXPECT_TRUE(subBasinRef.Initialize(basinSettings));
+    ModelHydro modelRef(&subBasinRef);
+    modelRef.Initialize(m_model2, basinSettings);
+    ASSERT_TRUE(modelRef.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(modelRef.AttachTimeSeriesToHydroUnits());
+    ASSERT_TRUE(modelRef.Run());
+    axd dischargeRef = modelRef.GetLogger()->GetOutletDischarge();
+
+    // Daily model with its own forcing
+    auto dataDaily = new TimeSeriesDataRegular(GetMJD(2020, 1, 1), GetMJD(2020, 1, 10), 1, Day);
+    dataDaily->SetValues({0.0, 10.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+    auto tsDaily = new TimeSeriesUniform(Precipitation);
+    tsDaily->SetData(dataDaily);
+
+    SubBasin subBasinDaily;
+    EXPECT_TRUE(subBasinDaily.Initialize(basinSettings));
+    ModelHydro modelDaily(&subBasinDaily);
+    modelDaily.Initialize(m_model2, basinSettings);
+    ASSERT_TRUE(modelDaily.AddTimeSeries(tsDaily));
+    ASSERT_TRUE(modelDaily.AttachTimeSeriesToHydroUnits());
+
+    // 6-hourly model running in parallel
+    SettingsModel modelSettingsHourly = m_model2;
+    modelSettingsHourly.SetTimer("2020-01-01", "2020-01-10", 6, "hour");
+    auto dataHourly = new TimeSeriesDataRegular(GetMJD(2020, 1, 1), GetMJD(2020, 1, 10), 6, Hour);
+    vecDouble valuesHourly(37, 0.0);
+    valuesHourly[4] = 10.0;
+    dataHourly->SetValues(valuesHourly);
+    auto tsHourly = new TimeSeriesUniform(Precipitation);
+    tsHourly->SetData(dataHourly);
+
+    SubBasin subBasinHourly;
+    EXPECT_TRUE(subBasinHourly.Initialize(basinSettings));
+    ModelHydro modelHourly(&subBasinHourly);
+    modelHourly.Initialize(modelSettingsHourly, basinSettings);
+    ASSERT_TRUE(modelHourly.AddTimeSeries(tsHourly));
+    ASSERT_TRUE(modelHourly.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_DOUBLE_EQ(modelDaily.GetProcessor()->GetTimeStepInDays(), 1.0);
+    EXPECT_DOUBLE_EQ(modelHourly.GetProcessor()->GetTimeStepInDays(), 0.25);
+
+    bool dailyOk = false;
+    bool hourlyOk = false;
+    std::thread threadDaily([&modelDaily, &dailyOk] { dailyOk = modelDaily.Run(); });
+    std::thread threadHourly([&modelHourly, &hourlyOk] { hourlyOk = modelHourly.Run(); });
+    threadDaily.join();
+    threadHourly.join();
+    ASSERT_TRUE(dailyOk);
+    ASSERT_TRUE(hourlyOk);
+
+    // The daily model is not affected by the time step of the other one
+    axd discharge = modelDaily.GetLogger()->GetOutletDischarge();
+    ASSERT_EQ(discharge.size(), dischargeRef.size());
+    for (int i = 0; i < discharge.size(); ++i) {
+        EXPECT_DOUBLE_EQ(discharge[i], dischargeRef[i]);
+    }
+
+    // Both models close their balance
+    double dischargeHourly = modelHourly.GetLogger()->GetTotalOutletDischarge();
+    double storageHourly = modelHourly.GetLogger()->GetTotalWaterStorageChanges();
+    EXPECT_NEAR(dischargeHourly + storageHourly - 10.0, 0.0, 0.0000001);
+
+    wxDELETE(tsDaily);
+    wxDELETE(tsHourly);
+}
@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 #include <wx/stdpaths.h>
 
+#include "ModelBatch.h"
+#include "ModelNetwork.h"
+#include "ModelEnsemble.h"
 #include "ModelHydro.h"
+#include "ModifierLag.h"
 #include "SettingsModel.h"
+#include "Snowpack.h"
 #include "TimeSeriesUniform.h"
 #include "helpers.h"
 
@@ -482,6 +487,749 @@ TEST_F(ModelSocontBasic, WaterBalanceClosesWith4HydroUnits) {
     EXPECT_NEAR(balance, 0.0, 0.0000001);
 }
 
+TEST_F(ModelSocontBasic, ParallelProcessingGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+    basinSettings.AddHydroUnit(3, 30);
+    basinSettings.AddLandCover("ground", "", 0);
+    basinSettings.AddLandCover("glacier", "", 1);
+    basinSettings.AddHydroUnit(4, 200);
+    basinSettings.AddLandCover("ground", "", 1);
+    basinSettings.AddLandCover("glacier", "", 0);
+    basinSettings.AddHydroUnit(5, 80);
+    basinSettings.AddLandCover("ground", "", 0.7);
+    basinSettings.AddLandCover("glacier", "", 0.3);
+
+    m_model.SetSolver("runge_kutta");
+
+    // Serial processing
+    SubBasin subBasinSerial;
+    EXPECT_TRUE(subBasinSerial.Initialize(basinSettings));
+    ModelHydro modelSerial(&subBasinSerial);
+    EXPECT_TRUE(modelSerial.Initialize(m_model, basinSettings));
+    ASSERT_TRUE(modelSerial.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(modelSerial.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(modelSerial.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(modelSerial.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(modelSerial.Run());
+    axd dischargeSerial = modelSerial.GetOutletDischarge();
+
+    // Parallel processing
+    m_model.SetThreadsNb(3);
+
+    SubBasin subBasinParallel;
+    EXPECT_TRUE(subBasinParallel.Initialize(basinSettings));
+    ModelHydro modelParallel(&subBasinParallel);
+    EXPECT_TRUE(modelParallel.Initialize(m_model, basinSettings));
+    EXPECT_EQ(modelParallel.GetProcessor()->GetThreadsNb(), 3);
+    ASSERT_TRUE(modelParallel.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(modelParallel.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(modelParallel.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(modelParallel.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(modelParallel.Run());
+    axd dischargeParallel = modelParallel.GetOutletDischarge();
+
+    ASSERT_EQ(dischargeSerial.size(), dischargeParallel.size());
+    for (int i = 0; i < dischargeSerial.size(); ++i) {
+        EXPECT_DOUBLE_EQ(dischargeSerial[i], dischargeParallel[i]);
+    }
+    EXPECT_GT(dischargeParallel.sum(), 0);
+}
+
+TEST_F(ModelSocontBasic, SkippingQuiescentBricksGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 30);
+    basinSettings.AddLandCover("ground", "", 0);
+    basinSettings.AddLandCover("glacier", "", 1);
+    basinSettings.AddHydroUnit(3, 200);
+    basinSettings.AddLandCover("ground", "", 1);
+    basinSettings.AddLandCover("glacier", "", 0);
+
+    m_model.SetSolver("runge_kutta");
+
+    vecAxd discharges;
+    vecDouble skippedFractions;
+    for (bool skipQuiescentBricks : {false, true}) {
+        m_model.SetSkipQuiescentBricks(skipQuiescentBricks);
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        discharges.push_back(model.GetOutletDischarge());
+        skippedFractions.push_back(model.GetSkippedBricksFraction());
+    }
+
+    ASSERT_EQ(discharges[0].size(), discharges[1].size());
+    for (int i = 0; i < discharges[0].size(); ++i) {
+        EXPECT_DOUBLE_EQ(discharges[0][i], discharges[1][i]);
+    }
+    EXPECT_GT(discharges[1].sum(), 0);
+    EXPECT_EQ(skippedFractions[0], 0);
+    EXPECT_GT(skippedFractions[1], 0);
+    EXPECT_LT(skippedFractions[1], 1);
+}
+
+TEST_F(ModelSocontBasic, SkippingQuiescentDirectBrickKeepsTheRatesOfTheNextOnes) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+
+    // The ground snowpack melts quickly and becomes quiescent while the glacier snowpack (processed after it) still
+    // melts.
+    EXPECT_TRUE(m_model.SetParameterValue("ground_snowpack", "degree_day_factor", 50));
+    EXPECT_TRUE(m_model.SetParameterValue("glacier_snowpack", "degree_day_factor", 1));
+
+    vecAxd discharges;
+    vector<vecDouble> states;
+    vecDouble skippedFractions;
+    for (bool skipQuiescentBricks : {false, true}) {
+        m_model.SetSkipQuiescentBricks(skipQuiescentBricks);
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        discharges.push_back(model.GetOutletDischarge());
+        states.push_back(model.GetState());
+        skippedFractions.push_back(model.GetSkippedBricksFraction());
+    }
+
+    ASSERT_EQ(discharges[0].size(), discharges[1].size());
+    for (int i = 0; i < discharges[0].size(); ++i) {
+        EXPECT_DOUBLE_EQ(discharges[0][i], discharges[1][i]);
+    }
+    ASSERT_EQ(states[0].size(), states[1].size());
+    for (int i = 0; i < states[0].size(); ++i) {
+        EXPECT_DOUBLE_EQ(states[0][i], states[1][i]);
+    }
+    EXPECT_GT(skippedFractions[1], 0);
+}
+
+TEST_F(ModelSocontBasic, EnsembleGivesSameResultsAsSingleRuns) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    vecFloat capacities = {50, 100, 200};
+    vecFloat meltFactors = {2, 3, 5};
+    vecFloat subSteps = {1, 10, 1};
+
+    // The number of sub steps is copied when building the bricks.
+    m_model.SelectSubBasinBrick("glacier_area_rain_snowmelt_storage");
+    m_model.AddBrickParameter("sub_steps", 1);
+
+    // Ensemble run
+    m_model.SetThreadsNb(2);
+    ModelEnsemble ensemble;
+    ASSERT_TRUE(ensemble.Initialize(m_model, basinSettings, 3));
+    EXPECT_EQ(ensemble.GetMembersNb(), 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(ensemble.SetParameterValue(i, "slow_reservoir", "capacity", capacities[i]));
+        EXPECT_TRUE(ensemble.SetParameterValue(i, "type:snowpack", "degree_day_factor", meltFactors[i]));
+        EXPECT_TRUE(ensemble.SetParameterValue(i, "glacier_area_rain_snowmelt_storage", "sub_steps", subSteps[i]));
+    }
+    ASSERT_TRUE(ensemble.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(ensemble.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(ensemble.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(ensemble.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(ensemble.Run());
+    axxd discharges = ensemble.GetOutletDischarges();
+    ASSERT_EQ(discharges.cols(), 3);
+
+    // Single runs
+    m_model.SetThreadsNb(1);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_TRUE(m_model.SetParameterValue("slow_reservoir", "capacity", capacities[i]));
+        EXPECT_TRUE(m_model.SetParameterValue("type:snowpack", "degree_day_factor", meltFactors[i]));
+        EXPECT_TRUE(m_model.SetParameterValue("glacier_area_rain_snowmelt_storage", "sub_steps", subSteps[i]));
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        axd discharge = model.GetOutletDischarge();
+
+        ASSERT_EQ(discharge.size(), discharges.rows());
+        for (int j = 0; j < discharge.size(); ++j) {
+            EXPECT_DOUBLE_EQ(discharges(j, i), discharge[j]);
+        }
+    }
+
+    // The members have different parameters
+    EXPECT_NE(discharges.col(0).sum(), discharges.col(2).sum());
+}
+
+TEST_F(ModelSocontBasic, CloneGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    // Warm up the model to start from a non-empty state
+    EXPECT_TRUE(model.Run());
+    model.SaveAsInitialState();
+    model.Reset();
+
+    SettingsModel cloneSettings(m_model);
+    ModelHydro* clone = model.Clone(cloneSettings);
+    ASSERT_TRUE(clone != nullptr);
+    EXPECT_TRUE(clone->IsOk());
+    EXPECT_EQ(clone->GetSubBasin()->GetHydroUnitsNb(), 2);
+    EXPECT_EQ(clone->GetSubBasin()->GetHydroUnit(1)->GetId(), 2);
+
+    EXPECT_TRUE(model.Run());
+    EXPECT_TRUE(clone->Run());
+    axd discharge = model.GetOutletDischarge();
+    axd dischargeClone = clone->GetOutletDischarge();
+    ASSERT_EQ(discharge.size(), dischargeClone.size());
+    for (int i = 0; i < discharge.size(); ++i) {
+        EXPECT_DOUBLE_EQ(dischargeClone[i], discharge[i]);
+    }
+
+    // The parameters of the clone are independent
+    EXPECT_TRUE(cloneSettings.SetParameterValue("type:snowpack", "degree_day_factor", 6));
+    clone->UpdateParameters(cloneSettings);
+    clone->Reset();
+    EXPECT_TRUE(clone->Run());
+    EXPECT_NE(clone->GetOutletDischarge().sum(), discharge.sum());
+    EXPECT_DOUBLE_EQ(model.GetOutletDischarge().sum(), discharge.sum());
+
+    SubBasin* cloneSubBasin = clone->GetSubBasin();
+    clone->ClearTimeSeries();
+    wxDELETE(clone);
+    wxDELETE(cloneSubBasin);
+}
+
+TEST_F(ModelSocontBasic, RestoredStateGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+    axd dischargeRef = model.GetOutletDischarge();
+
+    // Run the first time steps and save the state
+    model.Reset();
+    ASSERT_TRUE(model.PrepareRun());
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(model.ProcessTimeStep());
+        ASSERT_TRUE(model.UpdateForcing());
+    }
+    auto snowpack = dynamic_cast<Snowpack*>(model.GetSubBasin()->GetHydroUnit(1)->GetBrick("glacier_snowpack"));
+    ASSERT_TRUE(snowpack != nullptr);
+    int handle = model.SaveState();
+    double storageAtSave = snowpack->GetSnowContainer()->GetContentWithoutChanges();
+    EXPECT_GT(storageAtSave, 0);
+
+    // Finish the run, then restart from the saved state
+    while (!model.IsOver()) {
+        ASSERT_TRUE(model.ProcessTimeStep());
+        ASSERT_TRUE(model.UpdateForcing());
+    }
+    EXPECT_NE(snowpack->GetSnowContainer()->GetContentWithoutChanges(), storageAtSave);
+
+    ASSERT_TRUE(model.RestoreState(handle));
+    EXPECT_DOUBLE_EQ(snowpack->GetSnowContainer()->GetContentWithoutChanges(), storageAtSave);
+    EXPECT_TRUE(model.Run());
+
+    axd discharge = model.GetOutletDischarge();
+    ASSERT_EQ(discharge.size(), dischargeRef.size());
+    for (int i = 0; i < discharge.size(); ++i) {
+        EXPECT_DOUBLE_EQ(discharge[i], dischargeRef[i]);
+    }
+
+    wxLogNull logNo;
+    EXPECT_FALSE(model.RestoreState(handle + 1));
+    model.ClearStates();
+    EXPECT_FALSE(model.RestoreState(handle));
+}
+
+TEST_F(ModelSocontBasic, OutletLagGivesRoutedDischarge) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    SubBasin subBasinRef;
+    EXPECT_TRUE(subBasinRef.Initialize(basinSettings));
+    ModelHydro modelRef(&subBasinRef);
+    EXPECT_TRUE(modelRef.Initialize(m_model, basinSettings));
+    ASSERT_TRUE(modelRef.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(modelRef.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(modelRef.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(modelRef.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(modelRef.Run());
+
+    // Lag all the outputs to the outlet by the same kernel.
+    vecDouble parameters = {2, 1.5};
+    auto lagOutletProcesses = [this, &parameters]() {
+        for (int iProcess = 0; iProcess < m_model.GetProcessesNb(); ++iProcess) {
+            ProcessSettings processSettings = m_model.GetProcessSettings(iProcess);
+            if (!processSettings.outputs.empty() && processSettings.outputs[0].target == "outlet") {
+                m_model.SelectProcess(iProcess);
+                m_model.SetProcessOutputsLag("nash_cascade", parameters);
+            }
+        }
+    };
+    for (int iBrick = 0; iBrick < m_model.GetHydroUnitBricksNb(); ++iBrick) {
+        m_model.SelectHydroUnitBrick(iBrick);
+        lagOutletProcesses();
+    }
+    for (int iBrick = 0; iBrick < m_model.GetSubBasinBricksNb(); ++iBrick) {
+        m_model.SelectSubBasinBrick(iBrick);
+        lagOutletProcesses();
+    }
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+    model.AddTimeSeries(m_tsPrecip);
+    model.AddTimeSeries(m_tsTemp);
+    model.AddTimeSeries(m_tsPet);
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+    EXPECT_TRUE(model.Run());
+
+    // The routing is linear: lagging every flux is equivalent to routing the discharge.
+    axd expected = ModifierLag::ConvolveSeries(modelRef.GetOutletDischarge(),
+                                               ModifierLag::BuildKernel("nash_cascade", parameters));
+    axd discharge = model.GetOutletDischarge();
+    ASSERT_EQ(discharge.size(), expected.size());
+    for (int i = 0; i < discharge.size(); ++i) {
+        EXPECT_NEAR(discharge[i], expected[i], 0.0000001);
+    }
+    EXPECT_LT(discharge.maxCoeff(), modelRef.GetOutletDischarge().maxCoeff());
+
+    wxLogNull logNo;
+    EXPECT_FALSE(model.EnableBoundaryReplay());
+}
+
+TEST_F(ModelSocontBasic, BoundaryReplayGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    auto runReference = [&]() {
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        EXPECT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        EXPECT_TRUE(model.AddTimeSeries(m_tsTemp));
+        EXPECT_TRUE(model.AddTimeSeries(m_tsPet));
+        EXPECT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        return axd(model.GetOutletDischarge());
+    };
+
+    for (const char* solver : {"heun_explicit", "rk4"}) {
+        m_model.SetSolver(solver);
+        EXPECT_TRUE(m_model.SetParameterValue("glacier_area_icemelt_storage", "response_factor", 0.2f));
+        EXPECT_TRUE(m_model.SetParameterValue("type:snowpack", "degree_day_factor", 3));
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        ASSERT_TRUE(model.EnableBoundaryReplay());
+
+        // The first run records the inputs of the sub basin
+        EXPECT_TRUE(model.Run());
+        EXPECT_FALSE(model.IsReplayingBoundary());
+        axd dischargeFirst = model.GetOutletDischarge();
+        axd dischargeRef = runReference();
+        for (int i = 0; i < dischargeRef.size(); ++i) {
+            EXPECT_DOUBLE_EQ(dischargeFirst[i], dischargeRef[i]);
+        }
+
+        // Only a sub basin parameter changes: the hydro units are not simulated
+        EXPECT_TRUE(m_model.SetParameterValue("glacier_area_icemelt_storage", "response_factor", 0.6f));
+        model.UpdateParameters(m_model);
+        model.Reset();
+        EXPECT_TRUE(model.Run());
+        EXPECT_TRUE(model.IsReplayingBoundary());
+        axd discharge = model.GetOutletDischarge();
+        dischargeRef = runReference();
+        EXPECT_NE(dischargeRef.sum(), dischargeFirst.sum());
+        for (int i = 0; i < dischargeRef.size(); ++i) {
+            EXPECT_NEAR(discharge[i], dischargeRef[i], 1e-10);
+        }
+
+        // A hydro unit parameter changes: the model is fully simulated again
+        EXPECT_TRUE(m_model.SetParameterValue("type:snowpack", "degree_day_factor", 5));
+        model.UpdateParameters(m_model);
+        model.Reset();
+        EXPECT_TRUE(model.Run());
+        EXPECT_FALSE(model.IsReplayingBoundary());
+        discharge = model.GetOutletDischarge();
+        dischargeRef = runReference();
+        for (int i = 0; i < dischargeRef.size(); ++i) {
+            EXPECT_DOUBLE_EQ(discharge[i], dischargeRef[i]);
+        }
+
+        // The hydro units start from another state: the model is fully simulated again
+        model.SaveAsInitialState();
+        model.Reset();
+        EXPECT_TRUE(model.Run());
+        EXPECT_FALSE(model.IsReplayingBoundary());
+        dischargeFirst = model.GetOutletDischarge();
+        model.Reset();
+        EXPECT_TRUE(model.Run());
+        EXPECT_TRUE(model.IsReplayingBoundary());
+
+        SubBasin subBasinRef;
+        EXPECT_TRUE(subBasinRef.Initialize(basinSettings));
+        ModelHydro modelRef(&subBasinRef);
+        EXPECT_TRUE(modelRef.Initialize(m_model, basinSettings));
+        EXPECT_TRUE(modelRef.AddTimeSeries(m_tsPrecip));
+        EXPECT_TRUE(modelRef.AddTimeSeries(m_tsTemp));
+        EXPECT_TRUE(modelRef.AddTimeSeries(m_tsPet));
+        EXPECT_TRUE(modelRef.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(modelRef.Run());
+        modelRef.SaveAsInitialState();
+        modelRef.Reset();
+        EXPECT_TRUE(modelRef.Run());
+        dischargeRef = modelRef.GetOutletDischarge();
+        discharge = model.GetOutletDischarge();
+        for (int i = 0; i < dischargeRef.size(); ++i) {
+            EXPECT_DOUBLE_EQ(dischargeFirst[i], dischargeRef[i]);
+            EXPECT_NEAR(discharge[i], dischargeRef[i], 1e-10);
+        }
+    }
+}
+
+TEST_F(ModelSocontBasic, BoundaryReplayRequiresFixedStagesSolver) {
+    m_model.SetSolver("euler_implicit");
+
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+    ModelHydro model(&subBasin);
+    EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+
+    wxLogNull logNo;
+    EXPECT_FALSE(model.EnableBoundaryReplay());
+}
+
+TEST_F(ModelSocontBasic, BatchGivesSameResultsAsSingleRuns) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+    basinSettings.AddHydroUnit(2, 50);
+    basinSettings.AddLandCover("ground", "", 0.2);
+    basinSettings.AddLandCover("glacier", "", 0.8);
+
+    axxd parameters(5, 2);
+    parameters << 50, 2, 100, 3, 200, 5, 80, 4, 150, 6;
+
+    // Single runs
+    axxd dischargesRef(5, 10);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(m_model.SetParameterValue("slow_reservoir", "capacity", float(parameters(i, 0))));
+        EXPECT_TRUE(m_model.SetParameterValue("type:snowpack", "degree_day_factor", float(parameters(i, 1))));
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        axd discharge = model.GetOutletDischarge();
+        ASSERT_EQ(discharge.size(), 10);
+        dischargesRef.row(i) = discharge.transpose();
+    }
+
+    // Batch run with fewer workers than sets
+    ModelBatch batch;
+    ASSERT_TRUE(batch.Initialize(m_model, basinSettings, 3));
+    EXPECT_EQ(batch.GetWorkersNb(), 3);
+    ASSERT_TRUE(batch.SetParameterNames({"slow_reservoir", "type:snowpack"}, {"capacity", "degree_day_factor"}));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(batch.AttachTimeSeriesToHydroUnits());
+    axd observations = dischargesRef.row(0).transpose();
+    ASSERT_TRUE(batch.SetObservations(observations, "nse", 1));
+    EXPECT_TRUE(batch.Run(parameters));
+
+    axxd discharges = batch.GetOutletDischarges();
+    ASSERT_EQ(discharges.rows(), 5);
+    ASSERT_EQ(discharges.cols(), 10);
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 10; ++j) {
+            EXPECT_DOUBLE_EQ(discharges(i, j), dischargesRef(i, j));
+        }
+    }
+
+    // Objective values
+    axd objectives = batch.GetObjectiveValues();
+    ASSERT_EQ(objectives.size(), 5);
+    EXPECT_DOUBLE_EQ(objectives[0], 1.0);
+    for (int i = 1; i < 5; ++i) {
+        EXPECT_LT(objectives[i], 1.0);
+    }
+
+    // A second batch reuses the replicas
+    ASSERT_TRUE(batch.SetObservations(observations, "rmse"));
+    EXPECT_TRUE(batch.Run(parameters.bottomRows(2)));
+    objectives = batch.GetObjectiveValues();
+    ASSERT_EQ(objectives.size(), 2);
+    EXPECT_NEAR(objectives[1], std::sqrt((dischargesRef.row(4) - dischargesRef.row(0)).square().mean()), 1e-12);
+}
+
+TEST_F(ModelSocontBasic, BatchWarmupCacheReusesSpinUpStates) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+
+    axxd parameters(5, 2);
+    parameters << 50, 2, 100, 3, 50, 2, 100, 3, 50, 2;
+
+    ModelBatch batch;
+    ASSERT_TRUE(batch.Initialize(m_model, basinSettings, 2));
+    ASSERT_TRUE(batch.SetParameterNames({"slow_reservoir", "type:snowpack"}, {"capacity", "degree_day_factor"}));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(batch.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(batch.AttachTimeSeriesToHydroUnits());
+
+    // Reference without cache
+    EXPECT_TRUE(batch.Run(parameters));
+    axxd dischargesRef = batch.GetOutletDischarges();
+
+    // The spin-up is simulated once per distinct key
+    EXPECT_FALSE(batch.SetWarmupCache(10, {0, 1}));
+    EXPECT_FALSE(batch.SetWarmupCache(4, {2}));
+    ASSERT_TRUE(batch.SetWarmupCache(4, {0, 1}));
+    EXPECT_TRUE(batch.Run(parameters));
+    EXPECT_EQ(batch.GetWarmupCacheSize(), 2);
+
+    axxd discharges = batch.GetOutletDischarges();
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_TRUE(std::isnan(discharges(i, j)));
+        }
+        for (int j = 4; j < 10; ++j) {
+            EXPECT_NEAR(discharges(i, j), dischargesRef(i, j), 1e-12);
+        }
+    }
+
+    // Shared spin-up state for all sets, simulated with the first set whatever the threads scheduling
+    ModelBatch batchSerial;
+    ASSERT_TRUE(batchSerial.Initialize(m_model, basinSettings, 1));
+    ASSERT_TRUE(batchSerial.SetParameterNames({"slow_reservoir", "type:snowpack"}, {"capacity", "degree_day_factor"}));
+    ASSERT_TRUE(batchSerial.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(batchSerial.AddTimeSeries(m_tsTemp));
+    ASSERT_TRUE(batchSerial.AddTimeSeries(m_tsPet));
+    ASSERT_TRUE(batchSerial.AttachTimeSeriesToHydroUnits());
+    ASSERT_TRUE(batchSerial.SetWarmupCache(4, {}));
+    EXPECT_TRUE(batchSerial.Run(parameters));
+    axxd dischargesSerial = batchSerial.GetOutletDischarges();
+
+    ASSERT_TRUE(batch.SetWarmupCache(4, {}));
+    EXPECT_EQ(batch.GetWarmupCacheSize(), 0);
+    for (int run = 0; run < 3; ++run) {
+        EXPECT_TRUE(batch.Run(parameters));
+        EXPECT_EQ(batch.GetWarmupCacheSize(), 1);
+        discharges = batch.GetOutletDischarges();
+        for (int i = 0; i < 5; ++i) {
+            for (int j = 4; j < 10; ++j) {
+                EXPECT_DOUBLE_EQ(discharges(i, j), dischargesSerial(i, j));
+            }
+        }
+    }
+    for (int j = 4; j < 10; ++j) {
+        EXPECT_NEAR(discharges(0, j), dischargesRef(0, j), 1e-12);
+        EXPECT_NEAR(discharges(2, j), dischargesRef(2, j), 1e-12);
+    }
+
+    // The spin-up period without simulated values is not evaluated
+    axd observations = dischargesRef.row(1).transpose();
+    ASSERT_TRUE(batch.SetObservations(observations, "nse", 0));
+    EXPECT_TRUE(batch.Run(parameters));
+    axd objectives = batch.GetObjectiveValues();
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_FALSE(std::isnan(objectives[i]));
+    }
+}
+
+TEST_F(ModelSocontBasic, NetworkPassesDischargeDownstream) {
+    vector<SettingsBasin> basinsSettings(3);
+    vecDouble areas = {100, 50, 200};
+    for (int i = 0; i < 3; ++i) {
+        basinsSettings[i].AddHydroUnit(i + 1, areas[i]);
+        basinsSettings[i].AddLandCover("ground", "", 0.6);
+        basinsSettings[i].AddLandCover("glacier", "", 0.4);
+    }
+
+    // Standalone sub basins
+    axxd dischargesAlone(10, 3);
+    for (int i = 0; i < 3; ++i) {
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinsSettings[i]));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinsSettings[i]));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        dischargesAlone.col(i) = model.GetOutletDischarge();
+    }
+
+    for (int threadsNb : {1, 2}) {
+        ModelNetwork network;
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(network.AddSubBasin(m_model, basinsSettings[i]));
+        }
+        EXPECT_TRUE(network.Connect(0, 2));
+        EXPECT_TRUE(network.Connect(1, 2));
+        ASSERT_TRUE(network.Initialize(threadsNb));
+        EXPECT_EQ(network.GetLevelsNb(), 2);
+        ASSERT_TRUE(network.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(network.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(network.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(network.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(network.Run());
+
+        axxd discharges = network.GetOutletDischarges();
+        ASSERT_EQ(discharges.rows(), 10);
+        ASSERT_EQ(discharges.cols(), 3);
+        for (int t = 0; t < 10; ++t) {
+            EXPECT_DOUBLE_EQ(discharges(t, 0), dischargesAlone(t, 0));
+            EXPECT_DOUBLE_EQ(discharges(t, 1), dischargesAlone(t, 1));
+            double expected = dischargesAlone(t, 2) + dischargesAlone(t, 0) * areas[0] / areas[2] +
+                              dischargesAlone(t, 1) * areas[1] / areas[2];
+            EXPECT_NEAR(discharges(t, 2), expected, 1e-12);
+        }
+
+        // The volume at the last outlet is the sum of the volumes of all sub basins
+        double volume = discharges.col(2).sum() * areas[2];
+        double volumeAlone = 0;
+        for (int i = 0; i < 3; ++i) {
+            volumeAlone += dischargesAlone.col(i).sum() * areas[i];
+        }
+        EXPECT_NEAR(volume, volumeAlone, 1e-8);
+    }
+}
+
+TEST_F(ModelSocontBasic, NetworkRejectsCycles) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+
+    ModelNetwork network;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(network.AddSubBasin(m_model, basinSettings));
+    }
+
+    wxLogNull logNo;
+    EXPECT_FALSE(network.Connect(0, 0));
+    EXPECT_FALSE(network.Connect(0, 3));
+    EXPECT_TRUE(network.Connect(0, 1));
+    EXPECT_FALSE(network.Connect(0, 2));
+    EXPECT_TRUE(network.Connect(1, 2));
+    EXPECT_TRUE(network.Connect(2, 0));
+    EXPECT_FALSE(network.Initialize());
+    EXPECT_FALSE(network.Run());
+}
+
+TEST_F(ModelSocontBasic, NetworkIsUnchangedByARejectedSubBasin) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddLandCover("ground", "", 0.5);
+    basinSettings.AddLandCover("glacier", "", 0.5);
+
+    ModelNetwork network;
+    ASSERT_TRUE(network.AddSubBasin(m_model, basinSettings));
+
+    SettingsModel otherPeriod(m_model);
+    otherPeriod.SetTimer("2020-01-01", "2020-01-05", 1, "day");
+    wxLogNull logNo;
+    EXPECT_FALSE(network.AddSubBasin(otherPeriod, basinSettings));
+    EXPECT_EQ(network.GetSubBasinsNb(), 1);
+
+    ASSERT_TRUE(network.AddSubBasin(m_model, basinSettings));
+    EXPECT_EQ(network.GetSubBasinsNb(), 2);
+    EXPECT_TRUE(network.Connect(0, 1));
+    EXPECT_FALSE(network.Connect(1, 2));
+}
+
 TEST(ModelSocont, WaterBalanceCloses) {
     SettingsBasin basinSettings;
     EXPECT_TRUE(basinSettings.Parse("../../tests/files/catchments/ch_sitter_appenzell/hydro_units.nc"));
@@ -619,4 +1367,34 @@ TEST_F(ModelSocontSingleLandCover, QuickDischargeIsCorrect) {
     double balance = precip + totalGlacierMelt - discharge - et - storage;
 
     EXPECT_NEAR(balance, 0.0, 0.0000001);
-}
\ No newline at end of file
+}
+TEST_F(ModelSocontSingleLandCover, InlineRateKernelsGiveSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 38.9 * 1000000);
+    basinSettings.AddHydroUnitPropertyDouble("slope", 0.3, "m/m");
+    basinSettings.AddLandCover("ground", "", 1.0);
+
+    m_model.SetParameterValue("surface_runoff", "beta", 301);
+
+    vecAxd discharges;
+    for (bool inlineKernels : {false, true}) {
+        m_model.SetInlineRateKernels(inlineKernels);
+
+        SubBasin subBasin;
+        EXPECT_TRUE(subBasin.Initialize(basinSettings));
+        ModelHydro model(&subBasin);
+        EXPECT_TRUE(model.Initialize(m_model, basinSettings));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsTemp));
+        ASSERT_TRUE(model.AddTimeSeries(m_tsPet));
+        ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+        EXPECT_TRUE(model.Run());
+        discharges.push_back(model.GetOutletDischarge());
+    }
+
+    ASSERT_EQ(discharges[0].size(), discharges[1].size());
+    for (int i = 0; i < discharges[0].size(); ++i) {
+        EXPECT_DOUBLE_EQ(discharges[0][i], discharges[1][i]);
+    }
+    EXPECT_GT(discharges[1].sum(), 0);
+}
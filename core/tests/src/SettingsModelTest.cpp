@@ -72,3 +72,9 @@ TEST(SettingsModel, SetSharedParameters) {
     EXPECT_EQ(settings.GetHydroUnitBrickSettings("glacier_ice").processes[0].parameters[0]->GetValue(), 5);
     EXPECT_EQ(settings.GetHydroUnitBrickSettings("glacier_debris").processes[0].parameters[0]->GetValue(), 5);
 }
+
+TEST(SettingsModel, SetSolverTolerancesThrowsIfInvalid) {
+    SettingsModel settings;
+    EXPECT_THROW(settings.SetSolverTolerances(0, 0.001), InvalidArgument);
+    EXPECT_THROW(settings.SetSolverTolerances(0.001, -0.001), InvalidArgument);
+}
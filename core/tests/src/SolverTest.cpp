@@ -32,6 +32,26 @@ TEST(Solver, FactoryBuildsSolvers) {
     solver = Solver::Factory(settings);
     EXPECT_TRUE(solver != nullptr);
     wxDELETE(solver);
+
+    settings.name = "euler_implicit";
+    solver = Solver::Factory(settings);
+    EXPECT_TRUE(solver != nullptr);
+    wxDELETE(solver);
+
+    settings.name = "backward_euler";
+    solver = Solver::Factory(settings);
+    EXPECT_TRUE(solver != nullptr);
+    wxDELETE(solver);
+
+    settings.name = "bogacki_shampine";
+    solver = Solver::Factory(settings);
+    EXPECT_TRUE(solver != nullptr);
+    wxDELETE(solver);
+
+    settings.name = "rk23_adaptive";
+    solver = Solver::Factory(settings);
+    EXPECT_TRUE(solver != nullptr);
+    wxDELETE(solver);
 }
 
 TEST(Solver, FactoryThrowsExceptionIfNameInvalid) {
@@ -149,6 +169,37 @@ TEST_F(SolverLinearStorage, UsingHeunExplicit) {
     EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.00000000000001);
 }
 
+TEST_F(SolverLinearStorage, StateVariablesAreStoredInProcessor) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+    basinSettings.AddHydroUnit(2, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    Processor* processor = model.GetProcessor();
+    ASSERT_EQ(processor->GetNbStateVariables(), 2);
+    ASSERT_EQ(processor->GetStateVariableChanges()->size(), 2);
+
+    WaterContainer* container1 = subBasin.GetHydroUnit(0)->GetBrick(0)->GetWaterContainer();
+    WaterContainer* container2 = subBasin.GetHydroUnit(1)->GetBrick(0)->GetWaterContainer();
+
+    container1->AddAmountToDynamicContentChange(2.0);
+    container2->AddAmountToDynamicContentChange(3.0);
+    EXPECT_DOUBLE_EQ((*processor->GetStateVariableChanges())(0), 2.0);
+    EXPECT_DOUBLE_EQ((*processor->GetStateVariableChanges())(1), 3.0);
+
+    (*processor->GetStateVariableChanges())(1) = 5.0;
+    EXPECT_DOUBLE_EQ(container2->GetContentWithDynamicChanges(), 5.0);
+
+    container1->Finalize();
+    EXPECT_DOUBLE_EQ(container1->GetContentWithoutChanges(), 2.0);
+    EXPECT_DOUBLE_EQ((*processor->GetStateVariableChanges())(0), 0.0);
+}
+
 TEST_F(SolverLinearStorage, UsingRungeKutta) {
     SettingsBasin basinSettings;
     basinSettings.AddHydroUnit(1, 100);
@@ -186,6 +237,253 @@ TEST_F(SolverLinearStorage, UsingRungeKutta) {
     EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.00000000000001);
 }
 
+TEST_F(SolverLinearStorage, UsingBogackiShampine) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    m_model.SetSolver("bogacki_shampine");
+    m_model.SetSolverTolerances(0.00001, 0.00001);
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+
+    // Analytical solution of the linear storage: S(t) = P/k + (S0 - P/k) exp(-k t)
+    vecDouble precip = {0.0, 10.0, 10.0, 10.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                        0.0, 0.0,  0.0,  0.0,  0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    vecDouble expectedOutputs;
+    double content = 0;
+    for (double p : precip) {
+        double newContent = p / 0.3 + (content - p / 0.3) * std::exp(-0.3);
+        expectedOutputs.push_back(content + p - newContent);
+        content = newContent;
+    }
+
+    // Check resulting discharge
+    vecAxd basinOutputs = model.GetLogger()->GetSubBasinValues();
+
+    for (auto& basinOutput : basinOutputs) {
+        for (int j = 0; j < basinOutput.size(); ++j) {
+            EXPECT_NEAR(basinOutput[j], expectedOutputs[j], 0.0001);
+        }
+    }
+
+    // Check water balance
+    vecAxxd unitContent = model.GetLogger()->GetHydroUnitValues();
+    double storageContent = unitContent[0](19, 0);
+    EXPECT_NEAR(storageContent, content, 0.0001);
+    EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.00000000000001);
+}
+
+TEST_F(SolverLinearStorage, UsingBogackiShampineTwiceGivesSameResults) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    // Running during the rain only, with tight tolerances, so that the first run ends with a reduced sub-step
+    m_model.SetSolver("bogacki_shampine");
+    m_model.SetSolverTolerances(0.00000001, 0.00000001);
+    m_model.SetTimer("2020-01-02", "2020-01-04", 1, "day");
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+    vecAxd basinOutputsFirst = model.GetLogger()->GetSubBasinValues();
+
+    // The sub-step adapted during the first run must not be carried to the second one
+    model.Reset();
+    EXPECT_TRUE(model.Run());
+    vecAxd basinOutputsSecond = model.GetLogger()->GetSubBasinValues();
+
+    ASSERT_EQ(basinOutputsFirst.size(), basinOutputsSecond.size());
+    for (int i = 0; i < basinOutputsFirst.size(); ++i) {
+        ASSERT_EQ(basinOutputsFirst[i].size(), basinOutputsSecond[i].size());
+        for (int j = 0; j < basinOutputsFirst[i].size(); ++j) {
+            EXPECT_DOUBLE_EQ(basinOutputsFirst[i][j], basinOutputsSecond[i][j]);
+        }
+    }
+}
+
+TEST_F(SolverLinearStorage, UsingAnalyticalIntegration) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    m_model.SetSolver("runge_kutta");
+    m_model.SetAnalyticalLinearStorages();
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+
+    // Analytical solution of the linear storage: S(t) = P/k + (S0 - P/k) exp(-k t)
+    vecDouble precip = {0.0, 10.0, 10.0, 10.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                        0.0, 0.0,  0.0,  0.0,  0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    vecDouble expectedOutputs;
+    double k = 0.3f;
+    double content = 0;
+    for (double p : precip) {
+        double newContent = p / k + (content - p / k) * std::exp(-k);
+        expectedOutputs.push_back(content + p - newContent);
+        content = newContent;
+    }
+
+    // Check resulting discharge
+    vecAxd basinOutputs = model.GetLogger()->GetSubBasinValues();
+
+    for (auto& basinOutput : basinOutputs) {
+        for (int j = 0; j < basinOutput.size(); ++j) {
+            EXPECT_NEAR(basinOutput[j], expectedOutputs[j], 0.0000001);
+        }
+    }
+
+    // Check water balance
+    vecAxxd unitContent = model.GetLogger()->GetHydroUnitValues();
+    double storageContent = unitContent[0](19, 0);
+    EXPECT_NEAR(storageContent, content, 0.0000001);
+    EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.00000000000001);
+}
+
+TEST_F(SolverLinearStorage, UsingSubSteps) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    m_model.SelectHydroUnitBrick("storage");
+    m_model.AddBrickParameter("sub_steps", 100);
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+    EXPECT_EQ(subBasin.GetHydroUnit(0)->GetBrick(0)->GetSubStepsNb(), 100);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+
+    // Converges towards the analytical solution with inputs spread over the time step
+    vecDouble precip = {0.0, 10.0, 10.0, 10.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                        0.0, 0.0,  0.0,  0.0,  0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    vecDouble expectedOutputs;
+    double k = 0.3f;
+    double content = 0;
+    for (double p : precip) {
+        double newContent = p / k + (content - p / k) * std::exp(-k);
+        expectedOutputs.push_back(content + p - newContent);
+        content = newContent;
+    }
+
+    // Check resulting discharge
+    vecAxd basinOutputs = model.GetLogger()->GetSubBasinValues();
+
+    for (auto& basinOutput : basinOutputs) {
+        for (int j = 0; j < basinOutput.size(); ++j) {
+            EXPECT_NEAR(basinOutput[j], expectedOutputs[j], 0.02);
+        }
+    }
+
+    // Check water balance
+    vecAxxd unitContent = model.GetLogger()->GetHydroUnitValues();
+    double storageContent = unitContent[0](19, 0);
+    EXPECT_NEAR(storageContent, content, 0.02);
+    EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.000000000001);
+}
+
+TEST_F(SolverLinearStorage, UsingEulerImplicit) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    m_model.SetSolver("euler_implicit");
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+
+    // Implicit Euler solution of the linear storage: S(t+1) = (S(t) + P) / (1 + k)
+    vecDouble precip = {0.0, 10.0, 10.0, 10.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                        0.0, 0.0,  0.0,  0.0,  0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    vecDouble expectedOutputs;
+    double content = 0;
+    for (double p : precip) {
+        content = (content + p) / 1.3;
+        expectedOutputs.push_back(0.3 * content);
+    }
+
+    // Check resulting discharge
+    vecAxd basinOutputs = model.GetLogger()->GetSubBasinValues();
+
+    for (auto& basinOutput : basinOutputs) {
+        for (int j = 0; j < basinOutput.size(); ++j) {
+            EXPECT_NEAR(basinOutput[j], expectedOutputs[j], 0.000001);
+        }
+    }
+
+    // Check water balance
+    vecAxxd unitContent = model.GetLogger()->GetHydroUnitValues();
+    double storageContent = unitContent[0](19, 0);
+    EXPECT_NEAR(storageContent, content, 0.000001);
+    EXPECT_NEAR(30.0 - basinOutputs[0].sum() - storageContent, 0, 0.00000000000001);
+}
+
+TEST_F(SolverLinearStorage, UsingEulerImplicitOnStiffStorage) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    m_model.SetSolver("euler_implicit");
+    m_model.SetProcessParameterValue("response_factor", 20.0f);
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ASSERT_TRUE(model.AddTimeSeries(m_tsPrecip));
+    ASSERT_TRUE(model.AttachTimeSeriesToHydroUnits());
+
+    EXPECT_TRUE(model.Run());
+
+    // Check that the storage content stays smooth and positive
+    vecAxxd unitContent = model.GetLogger()->GetHydroUnitValues();
+    double content = 0;
+    for (int j = 0; j < 20; ++j) {
+        content = (content + (j >= 1 && j <= 3 ? 10.0 : 0.0)) / 21.0;
+        EXPECT_NEAR(unitContent[0](j, 0), content, 0.000001);
+    }
+
+    // Check water balance
+    vecAxd basinOutputs = model.GetLogger()->GetSubBasinValues();
+    EXPECT_NEAR(30.0 - basinOutputs[0].sum() - unitContent[0](19, 0), 0, 0.00000000000001);
+}
+
 /**
  * Model: 2 linear storages in cascade
  */
@@ -513,3 +811,38 @@ TEST_F(SolverLinearStorageWithET, UsingRungeKutta) {
     EXPECT_NEAR(storageContent, 0.605521, 0.000001);
     EXPECT_NEAR(30.0 - basinOutputs[0].sum() - unitContent[2].sum() - storageContent, 0, 0.00000000000001);
 }
+
+TEST_F(SolverLinearStorageWithET, ConstraintTableIsResolved) {
+    SettingsBasin basinSettings;
+    basinSettings.AddHydroUnit(1, 100);
+
+    SubBasin subBasin;
+    EXPECT_TRUE(subBasin.Initialize(basinSettings));
+
+    ModelHydro model(&subBasin);
+    model.Initialize(m_model, basinSettings);
+
+    ConstraintTable* table = model.GetProcessor()->GetConstraintTable();
+    ASSERT_EQ(table->constraints.size(), 1);
+    ASSERT_EQ(table->bricksStart.size(), 2);
+    EXPECT_EQ(table->bricksStart[0], 0);
+    EXPECT_EQ(table->bricksStart[1], 1);
+
+    ContainerConstraint& constraint = table->constraints[0];
+    EXPECT_EQ(constraint.container, subBasin.GetHydroUnit(0)->GetBrick(0)->GetWaterContainer());
+    EXPECT_EQ(constraint.ice, nullptr);
+    ASSERT_NE(constraint.capacity, nullptr);
+    EXPECT_FLOAT_EQ(*constraint.capacity, 20);
+
+    // Outflow, ET and overflow rates, in the order of the processes
+    ASSERT_EQ(constraint.outputsEnd - constraint.outputsStart, 3);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(table->rows[constraint.outputsStart + i], i);
+    }
+    EXPECT_EQ(constraint.overflowRow, 2);
+
+    // Precipitation as the only static input
+    EXPECT_EQ(constraint.inputsEnd, constraint.inputsStart);
+    ASSERT_EQ(constraint.staticInputsEnd - constraint.staticInputsStart, 1);
+    EXPECT_NE(table->staticInputs[constraint.staticInputsStart].forcing, nullptr);
+}
@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
+#include <fstream>
+#include <wx/stdpaths.h>
 
+#include "FileNetcdf.h"
+#include "Forcing.h"
+#include "SettingsBasin.h"
 #include "TimeSeriesData.h"
+#include "TimeSeriesDistributed.h"
+#include "TimeSeriesDistributedStream.h"
 #include "TimeSeriesUniform.h"
 
 TEST(TimeSeries, VariableType) {
@@ -28,6 +35,22 @@ TEST(TimeSeriesDataRegular, SetValueTooShort) {
     EXPECT_FALSE(tsData.SetValues({1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0}));
 }
 
+TEST(TimeSeriesDataRegular, CloneSharesValuesWithOwnCursor) {
+    TimeSeriesDataRegular tsData = TimeSeriesDataRegular(GetMJD(2020, 1, 1), GetMJD(2020, 1, 10), 1, Day);
+    EXPECT_TRUE(tsData.SetValues({1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0}));
+
+    TimeSeriesData* clone = tsData.CloneSharingValues();
+    EXPECT_TRUE(tsData.SetCursorToDate(GetMJD(2020, 1, 4)));
+    EXPECT_TRUE(clone->SetCursorToDate(GetMJD(2020, 1, 1)));
+    EXPECT_TRUE(clone->AdvanceOneTimeStep());
+
+    EXPECT_DOUBLE_EQ(tsData.GetCurrentValue(), 4.0);
+    EXPECT_DOUBLE_EQ(clone->GetCurrentValue(), 2.0);
+    EXPECT_DOUBLE_EQ(clone->GetSum(), 55.0);
+
+    wxDELETE(clone);
+}
+
 TEST(TimeSeries, ParseFile) {
     std::vector<TimeSeries*> vecTimeSeries;
     EXPECT_TRUE(TimeSeries::Parse("files/time-series-data.nc", vecTimeSeries));
@@ -38,9 +61,369 @@ TEST(TimeSeries, ParseFile) {
     EXPECT_EQ(vecTimeSeries[2]->GetVariableType(), PET);
 
     double date = GetMJD(2014, 10, 20);
-    EXPECT_FLOAT_EQ(vecTimeSeries[0]->GetDataPointer(3)->GetValueFor(date), 25.31445313f);
-    EXPECT_FLOAT_EQ(vecTimeSeries[0]->GetDataPointer(11)->GetValueFor(date), 23.58593750f);
+    EXPECT_FLOAT_EQ(vecTimeSeries[0]->GetValueFor(3, date), 25.31445313f);
+    EXPECT_FLOAT_EQ(vecTimeSeries[0]->GetValueFor(11, date), 23.58593750f);
 
     date = GetMJD(2014, 11, 27);
-    EXPECT_FLOAT_EQ(vecTimeSeries[1]->GetDataPointer(5)->GetValueFor(date), 8.23046875f);
+    EXPECT_FLOAT_EQ(vecTimeSeries[1]->GetValueFor(5, date), 8.23046875f);
+}
+
+TEST(TimeSeriesDistributed, ForcingReadsTheRowOfTheCurrentTimeStep) {
+    axd time(4);
+    time << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3), GetMJD(2020, 1, 4);
+    axi ids(3);
+    ids << 10, 20, 30;
+    axxd data(4, 3);
+    data << 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12;
+
+    TimeSeries* series = TimeSeries::Create("temperature", time, ids, data);
+    Forcing forcing20(Temperature);
+    Forcing forcing30(Temperature);
+    series->AttachForcing(&forcing20, 20);
+    series->AttachForcing(&forcing30, 30);
+
+    EXPECT_TRUE(series->SetCursorToDate(GetMJD(2020, 1, 2)));
+    EXPECT_DOUBLE_EQ(forcing20.GetValue(), 5);
+    EXPECT_DOUBLE_EQ(forcing30.GetValue(), 6);
+    EXPECT_TRUE(series->AdvanceOneTimeStep());
+    EXPECT_DOUBLE_EQ(forcing20.GetValue(), 8);
+    EXPECT_DOUBLE_EQ(forcing30.GetValue(), 9);
+    EXPECT_DOUBLE_EQ(series->GetValueFor(10, GetMJD(2020, 1, 4)), 10);
+
+    // The clone shares the values but has its own cursor.
+    TimeSeries* clone = series->CloneSharingValues();
+    Forcing forcingClone(Temperature);
+    clone->AttachForcing(&forcingClone, 20);
+    EXPECT_EQ(clone->GetCursor(), 2);
+    clone->SetCursor(0);
+    EXPECT_DOUBLE_EQ(forcingClone.GetValue(), 2);
+    EXPECT_DOUBLE_EQ(forcing20.GetValue(), 8);
+
+    wxDELETE(clone);
+    wxDELETE(series);
+}
+
+TEST(TimeSeriesDistributed, ExternalBlocksAreReadInPlace) {
+    axd time(4);
+    time << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3), GetMJD(2020, 1, 4);
+    axi ids(3);
+    ids << 10, 20, 30;
+    auto data = std::make_shared<axxd>(4, 3);
+    *data << 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12;
+    axxd transposed = data->transpose();
+    auto rowMajor = std::make_shared<vecDouble>(transposed.data(), transposed.data() + transposed.size());
+
+    // Eigen arrays are column-major, i.e. ordered by hydro unit.
+    TimeSeries* seriesUnitMajor = TimeSeries::Create("temperature", time, ids,
+                                                     std::shared_ptr<const double>(data, data->data()), true);
+    TimeSeries* seriesTimeMajor = TimeSeries::Create("temperature", time, ids,
+                                                     std::shared_ptr<const double>(rowMajor, rowMajor->data()));
+    Forcing forcingUnitMajor(Temperature);
+    Forcing forcingTimeMajor(Temperature);
+    seriesUnitMajor->AttachForcing(&forcingUnitMajor, 30);
+    seriesTimeMajor->AttachForcing(&forcingTimeMajor, 30);
+
+    for (int t = 0; t < time.size(); ++t) {
+        EXPECT_DOUBLE_EQ(forcingUnitMajor.GetValue(), (*data)(t, 2));
+        EXPECT_DOUBLE_EQ(forcingTimeMajor.GetValue(), (*data)(t, 2));
+        EXPECT_TRUE(seriesUnitMajor->AdvanceOneTimeStep());
+        EXPECT_TRUE(seriesTimeMajor->AdvanceOneTimeStep());
+    }
+    EXPECT_DOUBLE_EQ(seriesUnitMajor->GetValueFor(20, GetMJD(2020, 1, 3)), 8);
+    EXPECT_DOUBLE_EQ(seriesTimeMajor->GetValueFor(20, GetMJD(2020, 1, 3)), 8);
+
+    // The values are referenced, not copied.
+    (*data)(0, 2) = 100;
+    seriesUnitMajor->SetCursor(0);
+    EXPECT_DOUBLE_EQ(forcingUnitMajor.GetValue(), 100);
+
+    wxDELETE(seriesUnitMajor);
+    wxDELETE(seriesTimeMajor);
+}
+
+TEST(TimeSeriesDistributed, SinglePrecisionValuesAreConvertedWhenRead) {
+    axd time(4);
+    time << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3), GetMJD(2020, 1, 4);
+    axi ids(3);
+    ids << 10, 20, 30;
+    axxd data = axxd::Random(4, 3) * 100;
+
+    TimeSeries* series = TimeSeries::Create("precipitation", time, ids, data, true);
+    auto distributed = dynamic_cast<TimeSeriesDistributed*>(series);
+    ASSERT_TRUE(distributed);
+    EXPECT_TRUE(distributed->IsSinglePrecision());
+
+    Forcing forcing(Precipitation);
+    series->AttachForcing(&forcing, 20);
+    for (int t = 0; t < time.size(); ++t) {
+        EXPECT_EQ(forcing.GetValue(), double(float(data(t, 1))));
+        EXPECT_TRUE(series->AdvanceOneTimeStep());
+    }
+    EXPECT_EQ(series->GetValueFor(30, GetMJD(2020, 1, 2)), double(float(data(1, 2))));
+
+    // Float blocks ordered by hydro unit are also read in place.
+    auto block = std::make_shared<vecFloat>(data.data(), data.data() + data.size());
+    TimeSeries* seriesUnitMajor = TimeSeries::Create("precipitation", time, ids,
+                                                     std::shared_ptr<const void>(block, block->data()), true, true);
+    Forcing forcingUnitMajor(Precipitation);
+    seriesUnitMajor->AttachForcing(&forcingUnitMajor, 30);
+    EXPECT_TRUE(seriesUnitMajor->SetCursorToDate(GetMJD(2020, 1, 3)));
+    EXPECT_EQ(forcingUnitMajor.GetValue(), double(float(data(2, 2))));
+
+    wxDELETE(series);
+    wxDELETE(seriesUnitMajor);
+}
+
+TEST(TimeSeriesDistributed, DatesAreLookedUpAsForRegularData) {
+    axi ids(2);
+    ids << 10, 20;
+
+    // Hourly series over two days
+    double start = GetMJD(2020, 1, 1);
+    double end = IncrementDateBy(start, 47, Hour);
+    axxd data(48, 2);
+    data.col(0) = axd::LinSpaced(48, 0, 47);
+    data.col(1) = 100 + data.col(0);
+    auto series = new TimeSeriesDistributed(Temperature);
+    ASSERT_TRUE(series->SetValues(start, end, 1, Hour, {10, 20}, data));
+    TimeSeriesDataRegular regular(start, end, 1, Hour);
+    EXPECT_TRUE(regular.SetValues(vecDouble(data.col(1).data(), data.col(1).data() + 48)));
+
+    // The dates are truncated to the start of their day, on or off the grid of the series.
+    vecDouble dates = {GetMJD(2020, 1, 1), GetMJD(2020, 1, 1, 23), GetMJD(2020, 1, 2), GetMJD(2020, 1, 2, 6, 30)};
+    vecDouble expected = {100, 100, 124, 124};
+    Forcing forcing(Temperature);
+    series->AttachForcing(&forcing, 20);
+    for (int i = 0; i < dates.size(); ++i) {
+        EXPECT_DOUBLE_EQ(series->GetValueFor(20, dates[i]), expected[i]);
+        EXPECT_DOUBLE_EQ(regular.GetValueFor(dates[i]), expected[i]);
+        EXPECT_TRUE(series->SetCursorToDate(dates[i]));
+        EXPECT_DOUBLE_EQ(forcing.GetValue(), expected[i]);
+    }
+
+    // Daily series read at off-grid dates
+    axd timeDaily(4);
+    timeDaily << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3), GetMJD(2020, 1, 4);
+    axxd dataDaily(4, 2);
+    dataDaily << 1, 2, 3, 4, 5, 6, 7, 8;
+    TimeSeries* seriesDaily = TimeSeries::Create("temperature", timeDaily, ids, dataDaily);
+    EXPECT_DOUBLE_EQ(seriesDaily->GetValueFor(10, GetMJD(2020, 1, 2, 18)), 3);
+    EXPECT_DOUBLE_EQ(seriesDaily->GetValueFor(20, GetMJD(2020, 1, 3, 0, 1)), 6);
+
+    wxDELETE(series);
+    wxDELETE(seriesDaily);
+}
+
+TEST(TimeSeries, CacheGivesSameValuesAsCreate) {
+    axd time(5);
+    time << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3), GetMJD(2020, 1, 4), GetMJD(2020, 1, 5);
+    axi ids(3);
+    ids << 4, 8, 15;
+    axxd precip = axxd::Random(5, 3).abs() * 10;
+    axxd temp = axxd::Random(5, 3) * 5;
+    vecStr varNames = {"precipitation", "temperature"};
+
+    for (bool singlePrecision : {false, true}) {
+        string path = wxStandardPaths::Get().GetTempDir().ToStdString() + "/hb_test_forcing.bin";
+        ASSERT_TRUE(TimeSeries::WriteCache(path, time, ids, varNames, {precip, temp}, singlePrecision));
+
+        std::vector<TimeSeries*> vecTimeSeries;
+        ASSERT_TRUE(TimeSeries::ParseCache(path, vecTimeSeries));
+        ASSERT_EQ(vecTimeSeries.size(), 2);
+        EXPECT_EQ(vecTimeSeries[0]->GetVariableType(), Precipitation);
+        EXPECT_EQ(vecTimeSeries[1]->GetVariableType(), Temperature);
+        EXPECT_DOUBLE_EQ(vecTimeSeries[0]->GetStart(), time[0]);
+        EXPECT_DOUBLE_EQ(vecTimeSeries[0]->GetEnd(), time[4]);
+
+        Forcing forcing(Temperature);
+        vecTimeSeries[1]->AttachForcing(&forcing, 8);
+        ASSERT_TRUE(vecTimeSeries[1]->SetCursorToDate(time[0]));
+        for (int t = 0; t < time.size(); ++t) {
+            double expected = singlePrecision ? double(float(temp(t, 1))) : temp(t, 1);
+            EXPECT_DOUBLE_EQ(forcing.GetValue(), expected);
+            EXPECT_TRUE(vecTimeSeries[1]->AdvanceOneTimeStep());
+        }
+        double expected = singlePrecision ? double(float(precip(2, 2))) : precip(2, 2);
+        EXPECT_DOUBLE_EQ(vecTimeSeries[0]->GetValueFor(15, time[2]), expected);
+
+        for (auto timeSeries : vecTimeSeries) {
+            wxDELETE(timeSeries);
+        }
+    }
+}
+
+TEST(TimeSeries, CacheRejectsOtherFiles) {
+    string path = wxStandardPaths::Get().GetTempDir().ToStdString() + "/hb_test_forcing.bin";
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "This is not a forcing cache file.";
+    }
+
+    wxLogNull logNo;
+    std::vector<TimeSeries*> vecTimeSeries;
+    EXPECT_FALSE(TimeSeries::ParseCache(path, vecTimeSeries));
+    EXPECT_TRUE(vecTimeSeries.empty());
+    EXPECT_FALSE(TimeSeries::ParseCache(path + ".missing", vecTimeSeries));
+}
+
+TEST(TimeSeries, CacheRejectsCorruptedCounts) {
+    axd time(3);
+    time << GetMJD(2020, 1, 1), GetMJD(2020, 1, 2), GetMJD(2020, 1, 3);
+    axi ids(2);
+    ids << 1, 2;
+    axxd temp = axxd::Random(3, 2);
+    string path = wxStandardPaths::Get().GetTempDir().ToStdString() + "/hb_test_forcing.bin";
+
+    // Offsets of the number of time steps, of hydro units and of variables in the header, and the value written.
+    vector<std::pair<std::streamoff, uint64_t>> corruptions = {
+        {16, uint64_t(1) << 62}, {24, uint64_t(1) << 62}, {32, uint64_t(1) << 62}, {32, uint64_t(1) << 60},
+        {24, 0},                 {16, uint64_t(1) << 33}, {24, uint64_t(1) << 33}};
+
+    wxLogNull logNo;
+    for (const auto& corruption : corruptions) {
+        ASSERT_TRUE(TimeSeries::WriteCache(path, time, ids, {"temperature"}, {temp}));
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(corruption.first);
+            file.write(reinterpret_cast<const char*>(&corruption.second), sizeof(uint64_t));
+        }
+
+        std::vector<TimeSeries*> vecTimeSeries;
+        EXPECT_FALSE(TimeSeries::ParseCache(path, vecTimeSeries));
+        EXPECT_TRUE(vecTimeSeries.empty());
+    }
+}
+
+TEST(TimeSeriesDistributedStream, GivesSameValuesAsFullRead) {
+    std::vector<TimeSeries*> vecTimeSeries;
+    std::vector<TimeSeries*> vecStreams;
+    ASSERT_TRUE(TimeSeries::Parse("files/time-series-data.nc", vecTimeSeries));
+    ASSERT_TRUE(TimeSeries::Parse("files/time-series-data.nc", vecStreams, 7));
+    ASSERT_EQ(vecStreams.size(), vecTimeSeries.size());
+
+    vecInt unitIds = {3, 5, 11};
+    for (int i = 0; i < vecTimeSeries.size(); ++i) {
+        auto series = dynamic_cast<TimeSeriesDistributed*>(vecTimeSeries[i]);
+        auto stream = dynamic_cast<TimeSeriesDistributedStream*>(vecStreams[i]);
+        ASSERT_TRUE(series != nullptr);
+        ASSERT_TRUE(stream != nullptr);
+        ASSERT_EQ(stream->GetTimeStepsNb(), series->GetTimeStepsNb());
+        EXPECT_EQ(stream->GetVariableType(), series->GetVariableType());
+
+        vector<Forcing> forcings(unitIds.size(), Forcing(series->GetVariableType()));
+        vector<Forcing> forcingsStream(unitIds.size(), Forcing(series->GetVariableType()));
+        for (int u = 0; u < unitIds.size(); ++u) {
+            series->AttachForcing(&forcings[u], unitIds[u]);
+            stream->AttachForcing(&forcingsStream[u], unitIds[u]);
+        }
+
+        // Going through the chunks, then back to a previous chunk.
+        for (int t = 0; t < series->GetTimeStepsNb(); ++t) {
+            for (int u = 0; u < unitIds.size(); ++u) {
+                EXPECT_DOUBLE_EQ(forcingsStream[u].GetValue(), forcings[u].GetValue());
+            }
+            EXPECT_TRUE(series->AdvanceOneTimeStep());
+            EXPECT_TRUE(stream->AdvanceOneTimeStep());
+        }
+        series->SetCursor(10);
+        stream->SetCursor(10);
+        EXPECT_DOUBLE_EQ(forcingsStream[1].GetValue(), forcings[1].GetValue());
+        EXPECT_DOUBLE_EQ(stream->GetValueFor(11, GetMJD(2014, 10, 20)), series->GetValueFor(11, GetMJD(2014, 10, 20)));
+
+        TimeSeries* clone = stream->CloneSharingValues();
+        EXPECT_EQ(clone->GetCursor(), 10);
+        wxDELETE(clone);
+    }
+
+    for (auto timeSeries : vecTimeSeries) {
+        wxDELETE(timeSeries);
+    }
+    for (auto timeSeries : vecStreams) {
+        wxDELETE(timeSeries);
+    }
+}
+
+TEST(TimeSeriesDistributedStream, GeneratedFileGivesSameValuesAsFullRead) {
+    int timeStepsNb = 23;
+    vecInt unitIds = {2, 4, 6, 8};
+    vecFloat time;
+    for (int t = 0; t < timeStepsNb; ++t) {
+        time.push_back(float(GetMJD(2020, 1, 1) + t));
+    }
+    vecAxd temperature(timeStepsNb, axd::Zero(unitIds.size()));
+    vecAxd precipitation(unitIds.size(), axd::Zero(timeStepsNb));
+    for (int t = 0; t < timeStepsNb; ++t) {
+        for (int u = 0; u < unitIds.size(); ++u) {
+            temperature[t][u] = 0.5 * t - u;
+            precipitation[u][t] = (t * 7 + u * 3) % 11;
+        }
+    }
+
+    // One variable ordered by time step and one by hydro unit
+    wxString path = wxStandardPaths::Get().GetTempDir() + "/hb_test_stream.nc";
+    FileNetcdf file;
+    ASSERT_TRUE(file.Create(path.ToStdString()));
+    int dimTimeId = file.DefDim("time", timeStepsNb);
+    int dimUnitsId = file.DefDim("hydro_units", int(unitIds.size()));
+    int varTimeId = file.DefVarFloat("time", {dimTimeId});
+    int varIdsId = file.DefVarInt("id", {dimUnitsId});
+    int varTemperatureId = file.DefVarDouble("temperature", {dimTimeId, dimUnitsId}, 2);
+    int varPrecipitationId = file.DefVarDouble("precipitation", {dimUnitsId, dimTimeId}, 2);
+    file.PutVar(varTimeId, time);
+    file.PutVar(varIdsId, unitIds);
+    file.PutVar(varTemperatureId, temperature);
+    file.PutVar(varPrecipitationId, precipitation);
+    file.Close();
+
+    std::vector<TimeSeries*> vecTimeSeries;
+    std::vector<TimeSeries*> vecStreams;
+    ASSERT_TRUE(TimeSeries::Parse(path.ToStdString(), vecTimeSeries, 0));
+    ASSERT_TRUE(TimeSeries::Parse(path.ToStdString(), vecStreams, 5));
+    ASSERT_EQ(vecStreams.size(), 2);
+    ASSERT_EQ(vecTimeSeries.size(), 2);
+
+    SettingsBasin basinSettings;
+    for (int u = 0; u < unitIds.size(); ++u) {
+        basinSettings.AddHydroUnit(unitIds[u], 10.0 * (u + 1));
+    }
+
+    for (int i = 0; i < vecTimeSeries.size(); ++i) {
+        TimeSeries* series = vecTimeSeries[i];
+        TimeSeries* stream = vecStreams[i];
+        ASSERT_TRUE(dynamic_cast<TimeSeriesDistributedStream*>(stream) != nullptr);
+        EXPECT_EQ(stream->GetVariableType(), series->GetVariableType());
+
+        vector<Forcing> forcings(unitIds.size(), Forcing(series->GetVariableType()));
+        vector<Forcing> forcingsStream(unitIds.size(), Forcing(series->GetVariableType()));
+        for (int u = 0; u < unitIds.size(); ++u) {
+            series->AttachForcing(&forcings[u], unitIds[u]);
+            stream->AttachForcing(&forcingsStream[u], unitIds[u]);
+        }
+
+        for (int t = 0; t < timeStepsNb; ++t) {
+            for (int u = 0; u < unitIds.size(); ++u) {
+                EXPECT_DOUBLE_EQ(forcingsStream[u].GetValue(), forcings[u].GetValue());
+            }
+            EXPECT_TRUE(series->AdvanceOneTimeStep());
+            EXPECT_TRUE(stream->AdvanceOneTimeStep());
+        }
+
+        // The readers are used while the next chunk is being prefetched.
+        series->SetCursor(6);
+        stream->SetCursor(6);
+        EXPECT_NEAR(stream->GetTotal(&basinSettings), series->GetTotal(&basinSettings), 0.0000001);
+        for (int t = 0; t < timeStepsNb; ++t) {
+            double date = GetMJD(2020, 1, 1) + t;
+            EXPECT_DOUBLE_EQ(stream->GetValueFor(6, date), series->GetValueFor(6, date));
+        }
+        EXPECT_DOUBLE_EQ(forcingsStream[2].GetValue(), forcings[2].GetValue());
+    }
+
+    for (auto timeSeries : vecTimeSeries) {
+        wxDELETE(timeSeries);
+    }
+    for (auto timeSeries : vecStreams) {
+        wxDELETE(timeSeries);
+    }
+    wxRemoveFile(path);
 }
@@ -7,6 +7,7 @@ from _hydrobricks import (
     set_debug_log_level,
     set_max_log_level,
     set_message_log_level,
+    write_forcing_cache,
 )
 
 try:
@@ -342,6 +342,31 @@ class Forcing:
 
         nc.close()
 
+    def save_as_cache(self, path, single_precision=False):
+        """
+        Create a binary forcing cache, which is memory-mapped when used by a model
+        (see Model.set_forcing_from_cache()). Processes using the same cache share
+        the data in memory.
+
+        Parameters
+        ----------
+        path : str|Path
+            Path of the file to create.
+        single_precision : bool
+            Option to store the values as float32 instead of float64.
+        """
+        if not self.is_initialized():
+            print("Applying operations before saving...")
+            self.apply_operations()
+            self._is_initialized = True
+
+        time = self.data2D.get_dates_as_mjd()
+        ids = self.hydro_units[('id', '-')].values
+        data_names = [str(data_name) for data_name in self.data2D.data_name]
+        if not hb.write_forcing_cache(str(path), time, ids, data_names,
+                                      self.data2D.data, single_precision):
+            raise RuntimeError('Failed writing the forcing cache.')
+
     def load_from(self, path):
         """
         Load data from a netCDF file created using save_as().
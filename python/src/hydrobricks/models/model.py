@@ -172,14 +172,18 @@ class Model(ABC):
         self.run(parameters, forcing)
         self.model.save_as_initial_state()
 
-    def set_forcing(self, forcing):
+    def set_forcing(self, forcing, single_precision=False):
         """
-        Set the forcing data.
+        Set the forcing data. The data arrays are referenced by the model and not
+        copied when they are contiguous.
 
         Parameters
         ----------
         forcing : Forcing
             The forcing data.
+        single_precision : bool
+            Option to store the data as float32 instead of float64 (halves the
+            memory). Float32 data are always stored as such.
         """
         self.model.clear_time_series()
         time = forcing.data2D.time.to_numpy()
@@ -190,12 +194,30 @@ class Model(ABC):
             if data is None:
                 raise RuntimeError(f'The forcing {data_name} has not '
                                    f'been spatialized.')
-            if not self.model.create_time_series(data_name, time, ids, data):
+            if not self.model.create_time_series(data_name, time, ids, data,
+                                                 single_precision):
                 raise RuntimeError('Failed adding time series.')
 
         if not self.model.attach_time_series_to_hydro_units():
             raise RuntimeError('Attaching time series failed.')
 
+    def set_forcing_from_cache(self, path):
+        """
+        Set the forcing data from a binary forcing cache (see Forcing.save_as_cache()).
+        The file is memory-mapped and not copied.
+
+        Parameters
+        ----------
+        path : str|Path
+            Path of the forcing cache.
+        """
+        self.model.clear_time_series()
+        if not self.model.add_time_series_from_cache(str(path)):
+            raise RuntimeError('Failed adding the time series from the cache.')
+
+        if not self.model.attach_time_series_to_hydro_units():
+            raise RuntimeError('Attaching time series failed.')
+
     def add_behaviour(self, behaviour) -> bool:
         """
         Add a behaviour to the model.